@@ -0,0 +1,193 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <sstream>
+#include <random>
+#include "inc/_main.hxx"
+#include "inc/edgelist.hxx"
+
+using namespace std;
+
+
+
+
+#pragma region PARSERS
+/**
+* @brief Parse edgelist lines with the current tokenizer (see readEdgelistBodyDo).
+* @param ib begin of text
+* @param ie end of text
+* @param weighted are edge weights present?
+* @returns checksum of the parsed numbers.
+*/
+double parseCurrent(const char *ib, const char *ie, bool weighted) {
+  double a = 0;
+  readEdgelistBodyDo(ib, ie, weighted, [&](auto u, auto v, auto w) { a += u + v + w; });
+  return a;
+}
+
+
+/**
+* @brief Parse edgelist lines one digit at a time (as before the bulk tokenizer).
+* @param ib begin of text
+* @param ie end of text
+* @param weighted are edge weights present?
+* @returns checksum of the parsed numbers.
+*/
+double parseScalar(const char *ib, const char *ie, bool weighted) {
+  auto readUint = [&](size_t& x, const char *it) {
+    x = 0;
+    for (; it<ie && unsigned(*it-'0')<10; ++it)
+      x = x*10 + size_t(*it-'0');
+    return it;
+  };
+  double a = 0;
+  for (const char *it=ib; it<ie;) {
+    size_t u = 0, v = 0; double w = 1;
+    const char *iu = findNextNonBlank(it, ie), *ju = readUint(u, iu);
+    const char *iv = findNextNonBlank(ju, ie), *jv = readUint(v, iv);
+    if (weighted) jv = readFloatDigitsW(w, findNextNonBlank(jv, ie), ie);
+    if (ju!=iu && jv!=iv) a += u + v + w;
+    it = findNextLine(jv, ie);
+  }
+  return a;
+}
+
+
+/**
+* @brief Parse edgelist lines with strtoull and strtod.
+* @param ib begin of text (NUL-terminated)
+* @param ie end of text
+* @param weighted are edge weights present?
+* @returns checksum of the parsed numbers.
+*/
+double parseStrto(const char *ib, const char *ie, bool weighted) {
+  double a = 0;
+  for (const char *it=ib; it<ie;) {
+    char *ju, *jv;
+    size_t u = strtoull(it, &ju, 10);
+    size_t v = strtoull(ju, &jv, 10);
+    double w = 1;
+    if (weighted) w = strtod(jv, &jv);
+    if (ju!=it && jv!=ju) a += u + v + w;
+    it = findNextLine(jv, ie);
+  }
+  return a;
+}
+
+
+/**
+* @brief Parse edgelist lines with istringstream, one line at a time.
+* @param ib begin of text
+* @param ie end of text
+* @param weighted are edge weights present?
+* @returns checksum of the parsed numbers.
+*/
+double parseStream(const char *ib, const char *ie, bool weighted) {
+  double a = 0;
+  for (const char *it=ib; it<ie;) {
+    const char *jt = findNextLine(it, ie);
+    istringstream s(string(it, jt));
+    size_t u = 0, v = 0; double w = 1;
+    if (s >> u >> v && (!weighted || s >> w)) a += u + v + w;
+    it = jt;
+  }
+  return a;
+}
+#pragma endregion
+
+
+
+
+#pragma region INPUT
+/**
+* @brief Generate edgelist text, with a fixed seed.
+* @param edges number of edges (lines).
+* @param vertices number of vertices.
+* @param weighted add edge weights?
+* @returns text of the edgelist.
+*/
+string generateText(size_t edges, size_t vertices, bool weighted) {
+  mt19937_64 rng(42);
+  uniform_int_distribution<size_t> dv(1, vertices);
+  uniform_real_distribution<double> dw(0, 1);
+  string a; char buf[64];
+  for (size_t i=0; i<edges; ++i) {
+    int n = weighted ? snprintf(buf, sizeof(buf), "%zu %zu %.6f\n", dv(rng), dv(rng), dw(rng)) : snprintf(buf, sizeof(buf), "%zu %zu\n", dv(rng), dv(rng));
+    a.append(buf, n);
+  }
+  return a;
+}
+
+
+/**
+* @brief Skip the header of an MTX file (comments, and the size line).
+* @param data file contents.
+* @returns offset of the body.
+*/
+size_t skipMtxHeader(string_view data) {
+  const char *ib = data.data(), *ie = ib + data.size(), *it = ib;
+  for (; it<ie && *it=='%'; it=findNextLine(it, ie));
+  return findNextLine(it, ie) - ib;
+}
+#pragma endregion
+
+
+
+
+#pragma region MAIN
+/**
+* @brief Time each parser on a text, and print its throughput.
+* @param name name of the input.
+* @param text edgelist body text (NUL-terminated).
+* @param weighted are edge weights present?
+* @param repeat number of timed runs of each parser (best is reported).
+*/
+void runBenchmark(const string& name, string_view text, bool weighted, int repeat) {
+  const char *ib = text.data(), *ie = ib + text.size();
+  printf("%s: %.1f MB%s\n", name.c_str(), text.size() / 1e6, weighted ? " (weighted)" : "");
+  auto run = [&](const char *parser, auto fp) {
+    double check = 0; float best = 0;
+    for (int i=0; i<repeat; ++i) {
+      float t = measureDuration([&]() { check = fp(ib, ie, weighted); });
+      if (i==0 || t < best) best = t;
+    }
+    printf("  %-14s %8.1f ms %6.3f GB/s  [checksum %.6e]\n", parser, best, text.size() / 1e6 / best, check);
+  };
+  run("current", parseCurrent);
+  run("scalar",  parseScalar);
+  run("strtoull",  parseStrto);
+  run("istringstream", parseStream);
+}
+
+
+/**
+* @brief Benchmark the edgelist/MTX number tokenizer against other parsers.
+* @param argc argument count.
+* @param argv paths of MTX (.mtx) or edgelist files; synthetic inputs are used if none.
+* @returns zero on success.
+*/
+int main(int argc, char **argv) {
+  int repeat = getenv("REPEAT") ? atoi(getenv("REPEAT")) : 3;
+  if (argc < 2) {
+    string unweighted = generateText(10000000, 1000000, false);
+    string weighted   = generateText(3000000,  1000000, true);
+    runBenchmark("synthetic 10M-edge edgelist", unweighted, false, repeat);
+    runBenchmark("synthetic 3M-edge weighted edgelist", weighted, true, repeat);
+    return 0;
+  }
+  for (int i=1; i<argc; ++i) {
+    MappedFile file(argv[i]);
+    string text(file.view());  // Copy, so that the text is NUL-terminated for strtoull.
+    string pth = argv[i];
+    bool mtx = pth.size() > 4 && pth.substr(pth.size()-4) == ".mtx";
+    size_t b = mtx ? skipMtxHeader(text) : 0;
+    size_t u = 0, v = 0; double w = 0;
+    const char *jt = readEdgelistLineW(u, v, w, text.data() + b, text.data() + text.size(), true);
+    bool weighted = w != 0 && jt != text.data() + b;
+    runBenchmark(pth, string_view(text).substr(b), weighted, repeat);
+  }
+  return 0;
+}
+#pragma endregion
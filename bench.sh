@@ -0,0 +1,11 @@
+#!/usr/bin/env bash
+src="graph-generate"
+out="$HOME/Logs/$src-bench.log"
+ulimit -s unlimited
+mkdir -p "$HOME/Logs"
+printf "" > "$out"
+
+# Benchmark number tokenizing (parse only, single thread), on the given
+# MTX/edgelist files, or on synthetic inputs (fixed seed) if none.
+g++ -std=c++17 -O3 bench.cxx -o bench.out
+stdbuf --output=L ./bench.out "$@" 2>&1 | tee -a "$out"
@@ -4,6 +4,9 @@
 #include <ostream>
 #include <algorithm>
 #include "_main.hxx"
+#ifdef OPENMP
+#include <omp.h>
+#endif
 
 using std::pair;
 using std::vector;
@@ -15,12 +18,13 @@ using std::max;
 
 #pragma region CLASSES
 /**
- * Directed graph that memorizes only out-edges for each vertex.
+ * Directed graph that memorizes out-edges, and optionally in-edges, for each vertex.
  * @tparam K key type (vertex id)
  * @tparam V vertex value type (vertex data)
  * @tparam E edge value type (edge weight)
+ * @tparam REV memorize in-edges too? (needed for indegree())
  */
-template <class K=uint32_t, class V=None, class E=None>
+template <class K=uint32_t, class V=None, class E=None, bool REV=true>
 class DiGraph {
   #pragma region TYPES
   public:
@@ -39,14 +43,165 @@ class DiGraph {
   size_t N = 0;
   /** Number of edges. */
   size_t M = 0;
-  /** Vertex existence flags. */
-  vector<bool> exists;
+  /** Span of the graph (one more than the largest vertex id). */
+  size_t S = 0;
+  /** Vertex existence flags, packed 64 to a word. */
+  vector<uint64_t> exists;
+  /** Non-empty words of vertex existence flags, packed 64 to a word. */
+  vector<uint64_t> existsWords;
   /** Vertex values. */
   vector<V> values;
   /** Outgoing edges for each vertex (including edge weights). */
   vector<LazyBitset<K, E>> edges;
+  /** Incoming edges for each vertex (including edge weights), if memorized. */
   vector<LazyBitset<K, E>> edges_rev;
+  /** Vertex pending update flags. */
+  vector<char> dirty;
+  /** Vertices pending update, with their counted degree, for each thread that marked them. */
+  vector2d<pair<K, size_t>> dirtyVertices = vector2d<pair<K, size_t>>(maxThreads());
+  /** Change in the number of vertices pending update, for each thread. */
+  vector<ssize_t> dirtyOrders = vector<ssize_t>(maxThreads());
+  /** Scratch buffers for updating edges, for each thread (kept across updates). */
+  vector2d<pair<K, E>> updateBuffers = vector2d<pair<K, E>>(maxThreads());
+  #pragma endregion
+
+
+  #pragma region HELPERS
+  protected:
+  /**
+   * Get the number of threads that may change the graph at once.
+   * @returns maximum number of threads
+   */
+  static inline size_t maxThreads() noexcept {
+    #ifdef OPENMP
+    return size_t(omp_get_max_threads());
+    #else
+    return 1;
+    #endif
+  }
+
+  /**
+   * Get the list of vertices pending update, of the current thread.
+   * @returns vertices pending update (with their counted degree)
+   */
+  inline vector<pair<K, size_t>>& threadDirtyVertices() noexcept {
+    #ifdef OPENMP
+    return dirtyVertices[omp_get_thread_num()];
+    #else
+    return dirtyVertices[0];
+    #endif
+  }
+
+  /**
+   * Get the change in the number of vertices pending update, of the current thread.
+   * @returns change in |V| (to be applied by update())
+   */
+  inline ssize_t& threadDirtyOrder() noexcept {
+    #ifdef OPENMP
+    return dirtyOrders[omp_get_thread_num()];
+    #else
+    return dirtyOrders[0];
+    #endif
+  }
+
+  /**
+   * Get the scratch buffer for updating edges, of the current thread.
+   * @returns scratch buffer
+   */
+  inline vector<pair<K, E>>& threadUpdateBuffer() noexcept {
+    #ifdef OPENMP
+    return updateBuffers[omp_get_thread_num()];
+    #else
+    return updateBuffers[0];
+    #endif
+  }
+
+  /**
+   * Check if a vertex exists, given that it is within the span.
+   * @param u vertex id
+   * @returns does the vertex exist?
+   */
+  inline bool testVertex(K u) const noexcept {
+    return (exists[u/64] >> (u%64)) & 1;
+  }
+
+  /**
+   * Mark a vertex, within the span, as existing.
+   * @param u vertex id
+   * @note A word of flags lies within the vertices of one owner thread (see
+   * belongsOmp()), but a word of non-empty words does not, and is thus
+   * updated atomically.
+   */
+  inline void setVertex(K u) noexcept {
+    size_t i = u/64;
+    uint64_t b = uint64_t(1) << (i%64);
+    uint64_t& g = existsWords[i/64];
+    exists[i] |= uint64_t(1) << (u%64);
+    #pragma omp atomic
+    g |= b;
+  }
+
+  /**
+   * Mark a vertex, within the span, as not existing.
+   * @param u vertex id
+   * @note See setVertex().
+   */
+  inline void unsetVertex(K u) noexcept {
+    size_t i = u/64;
+    uint64_t b = ~(uint64_t(1) << (i%64));
+    uint64_t& g = existsWords[i/64];
+    exists[i] &= ~(uint64_t(1) << (u%64));
+    if (exists[i]!=0) return;
+    #pragma omp atomic
+    g &= b;
+  }
 
+  /**
+   * Resize the vertex existence flags, dropping vertices beyond the new span.
+   * @param n new span
+   */
+  inline void resizeExists(size_t n) {
+    size_t I = (n+63)/64;
+    exists.resize(I);
+    existsWords.resize((I+63)/64);
+    if (n%64!=0) {
+      exists[I-1] &= (uint64_t(1) << (n%64)) - 1;
+      if (exists[I-1]==0) existsWords[(I-1)/64] &= ~(uint64_t(1) << ((I-1)%64));
+    }
+    if (I%64!=0) existsWords[I/64] &= (uint64_t(1) << (I%64)) - 1;
+  }
+
+  /**
+   * Iterate over the vertex ids in a range of non-empty word groups.
+   * @param jb begin group (of 64 words, or 4096 vertices)
+   * @param je end group
+   * @param fp process function (vertex id)
+   * @note Words without any vertex are skipped, so that the cost is
+   * proportional to the number of vertices, rather than the span.
+   */
+  template <class FP>
+  inline void forEachVertexKeyIn(size_t jb, size_t je, FP fp) const noexcept {
+    for (size_t j=jb; j<je; ++j) {
+      for (uint64_t g=existsWords[j]; g; g&=g-1) {
+        size_t i = j*64 + __builtin_ctzll(g);
+        for (uint64_t w=exists[i]; w; w&=w-1)
+          fp(K(i*64 + __builtin_ctzll(w)));
+      }
+    }
+  }
+
+  /**
+   * Mark a vertex as pending update, before it is changed.
+   * @param u vertex id
+   * @note The degree of the vertex, as counted in |E|, is recorded so that
+   * |E| can be adjusted once the vertex is updated. A vertex must only be
+   * changed by the thread that owns it (see belongsOmp()).
+   */
+  inline void markDirty(K u) {
+    if (dirty[u]) return;
+    dirty[u] = true;
+    threadDirtyVertices().push_back({u, testVertex(u)? edges[u].size() : 0});
+  }
   #pragma endregion
 
 
@@ -59,12 +214,12 @@ class DiGraph {
    * @returns size of buffer required
    */
   inline size_t span() const noexcept {
-    return exists.size();
+    return S;
   }
 
   /**
    * Get the number of vertices in the graph.
-   * @returns |V|
+   * @returns |V| (as of the last update())
    */
   inline size_t order() const noexcept {
     return N;
@@ -93,6 +248,14 @@ class DiGraph {
   inline bool directed() const noexcept {
     return true;
   }
+
+  /**
+   * Check if the graph memorizes incoming edges.
+   * @returns are incoming edges memorized?
+   */
+  static constexpr bool hasInEdges() noexcept {
+    return REV;
+  }
   #pragma endregion
 
 
@@ -104,8 +267,7 @@ class DiGraph {
    */
   template <class FP>
   inline void forEachVertex(FP fp) const noexcept {
-    for (K u=0; u<span(); ++u)
-      if (exists[u]) fp(u, values[u]);
+    forEachVertexKeyIn(0, existsWords.size(), [&](K u) { fp(u, values[u]); });
   }
 
   /**
@@ -114,10 +276,32 @@ class DiGraph {
    */
   template <class FP>
   inline void forEachVertexKey(FP fp) const noexcept {
-    for (K u=0; u<span(); ++u)
-      if (exists[u]) fp(u);
+    forEachVertexKeyIn(0, existsWords.size(), fp);
   }
 
+  #ifdef OPENMP
+  /**
+   * Iterate over the vertices in the graph, in parallel.
+   * @param fp process function (vertex id, vertex data), called from multiple threads
+   */
+  template <class FP>
+  inline void forEachVertexOmp(FP fp) const noexcept {
+    forEachVertexKeyOmp([&](K u) { fp(u, values[u]); });
+  }
+
+  /**
+   * Iterate over the vertex ids in the graph, in parallel.
+   * @param fp process function (vertex id), called from multiple threads
+   */
+  template <class FP>
+  inline void forEachVertexKeyOmp(FP fp) const noexcept {
+    size_t J = existsWords.size();
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t j=0; j<J; ++j)
+      forEachVertexKeyIn(j, j+1, fp);
+  }
+  #endif
+
   /**
    * Iterate over the outgoing edges of a source vertex in the graph.
    * @param u source vertex id
@@ -148,7 +332,7 @@ class DiGraph {
    * @returns does the vertex exist?
    */
   inline bool hasVertex(K u) const noexcept {
-    return u < span() && exists[u];
+    return u < span() && testVertex(u);
   }
 
   /**
@@ -176,6 +360,7 @@ class DiGraph {
    * @returns number of ingoing edges of the vertex
    */
   inline size_t indegree(K u) const noexcept {
+    static_assert(REV, "In-degrees need a graph that memorizes in-edges.");
     return u < span()? edges_rev[u].size() : 0;
   }
 
@@ -232,11 +417,15 @@ class DiGraph {
    * Remove all vertices and edges from the graph.
    */
   inline void clear() noexcept {
-    N = 0; M = 0;
+    N = 0; M = 0; S = 0;
     exists.clear();
+    existsWords.clear();
     values.clear();
     edges.clear();
-    edges_rev.clear();
+    if constexpr (REV) edges_rev.clear();
+    dirty.clear();
+    dirtyVertices.assign(maxThreads(), {});
+    dirtyOrders.assign(maxThreads(), 0);
   }
 
   /**
@@ -248,6 +437,15 @@ class DiGraph {
     if (u < span()) edges[u].reserve(deg);
   }
 
+  /**
+   * Reserve space for incoming edges of a vertex in the graph.
+   * @param v target vertex id
+   * @param deg expected in-degree of the vertex
+   */
+  inline void reserveInEdges(K v, size_t deg) {
+    if constexpr (REV) { if (v < span()) edges_rev[v].reserve(deg); }
+  }
+
 
   /**
    * Reserve space for a number of vertices and edges in the graph.
@@ -255,13 +453,9 @@ class DiGraph {
    * @param deg expected average degree of vertices
    */
   inline void reserve(size_t n, size_t deg=0) {
-    size_t S = max(n, span());
-    exists.resize(S);
-    values.resize(S);
-    edges.resize(S);
-    edges_rev.resize(S);
+    if (n > span()) respan(n);
     if (deg==0) return;
-    for (K u=0; u<S; ++u)
+    for (K u=0; u<span(); ++u)
       edges[u].reserve(deg);
       // edges_rev[u].resize(deg);
   }
@@ -269,59 +463,149 @@ class DiGraph {
   /**
    * Adjust the span of the graph.
    * @param n new span
-   * @note This operation is lazy.
+   * @note This operation is lazy, unless the span shrinks.
    */
   inline void respan(size_t n) {
-    exists.resize(n);
+    if (n < span()) {
+      update();
+      for (size_t i=n/64; i<exists.size(); ++i) {
+        uint64_t w = exists[i];
+        if (i==n/64) w &= ~((uint64_t(1) << (n%64)) - 1);
+        N -= __builtin_popcountll(w);
+        for (; w; w&=w-1)
+          M -= edges[i*64 + __builtin_ctzll(w)].size();
+      }
+    }
+    S = n;
+    resizeExists(n);
     values.resize(n);
     edges.resize(n);
-    edges_rev.resize(n);
+    if constexpr (REV) edges_rev.resize(n);
+    dirty.resize(n);
+    if (dirtyVertices.size() < maxThreads()) dirtyVertices.resize(maxThreads());
+    if (dirtyOrders.size()   < maxThreads()) dirtyOrders.resize(maxThreads());
+    if (updateBuffers.size() < maxThreads()) updateBuffers.resize(maxThreads());
   }
 
   /**
    * Update the outgoing edges of a vertex in the graph to reflect the changes.
    * @param u source vertex id
    * @param buf scratch buffer for the update
+   * @note The number of edges is adjusted only by update().
    */
   inline void updateEdges(K u, vector<pair<K, E>> *buf=nullptr) {
     if (u < span()) edges[u].update(buf);
   }
 
+  /**
+   * Get the vertices pending update, as marked by each thread.
+   * @returns vertices pending update, with their degree as counted in |E|
+   */
+  inline const vector2d<pair<K, size_t>>& pendingVertices() const noexcept {
+    return dirtyVertices;
+  }
+
+  /**
+   * Update the outgoing and incoming edges of a vertex pending update to reflect the changes.
+   * @param u vertex id
+   * @param deg degree of the vertex, as counted in |E| (see pendingVertices())
+   * @returns change in the number of edges
+   * @note Different vertices may be updated in parallel, each thread using
+   * its own scratch buffer.
+   */
+  inline ssize_t updatePendingVertex(K u, size_t deg) {
+    vector<pair<K, E>>& buf = threadUpdateBuffer();
+    edges[u].update(&buf);
+    if constexpr (REV) edges_rev[u].update(&buf);
+    dirty[u] = false;
+    return ssize_t(testVertex(u)? edges[u].size() : 0) - ssize_t(deg);
+  }
+
+  /**
+   * Finish updating the vertices pending update.
+   * @param dm total change in the number of edges (see updatePendingVertex())
+   * @note The changes in the number of vertices, counted by each thread, are
+   * applied here.
+   */
+  inline void finishPendingUpdate(ssize_t dm) {
+    ssize_t dn = 0;
+    for (auto& n : dirtyOrders)
+      { dn += n; n = 0; }
+    N = size_t(ssize_t(N) + dn);
+    M = size_t(ssize_t(M) + dm);
+    for (auto& d : dirtyVertices)
+      d.clear();
+  }
+
+  /**
+   * Replace the outgoing edges of a vertex in the graph.
+   * @param u source vertex id
+   * @param ib begin of edges (target vertex id, edge weight), sorted by target
+   * @param ie end of edges
+   */
+  template <class I>
+  inline void assignEdges(K u, I ib, I ie) {
+    if (u >= span()) return;
+    markDirty(u);
+    edges[u].assign(ib, ie);
+  }
+
+  /**
+   * Replace the incoming edges of a vertex in the graph.
+   * @param v target vertex id
+   * @param ib begin of edges (source vertex id, edge weight), sorted by source
+   * @param ie end of edges
+   * @note Does nothing if incoming edges are not memorized.
+   */
+  template <class I>
+  inline void assignInEdges(K v, I ib, I ie) {
+    if constexpr (REV) {
+      if (v >= span()) return;
+      markDirty(v);
+      edges_rev[v].assign(ib, ie);
+    }
+  }
+
   /**
    * Update the graph to reflect the changes.
-   * @note This is an expensive operation.
+   * @note Only vertices changed since the last update are visited.
    */
   inline void update() {
-    vector<pair<K, E>> buf;
-    N = 0; M = 0;
-    forEachVertexKey([&](K u) {
-      edges[u].update(&buf);
-      M += degree(u); ++N;
-    });
+    ssize_t dm = 0;
+    for (const auto& d : dirtyVertices) {
+      for (const auto& [u, deg] : d)
+        dm += updatePendingVertex(u, deg);
+    }
+    finishPendingUpdate(dm);
   }
 
   /**
    * Add a vertex to the graph.
    * @param u vertex id
-   * @note This operation is lazy.
+   * @note This operation is lazy. In parallel, a vertex must only be added by
+   * the thread that owns it (see belongsOmp()), and within the span.
    */
   inline void addVertex(K u) {
     if (hasVertex(u)) return;
     if (u >= span()) respan(u+1);
-    exists[u] = true;
+    markDirty(u);
+    setVertex(u);
+    ++threadDirtyOrder();
   }
 
   /**
    * Add a vertex to the graph.
    * @param u vertex id
    * @param d associated data of the vertex
-   * @note This operation is lazy.
+   * @note This operation is lazy. In parallel, see addVertex(u).
    */
   inline void addVertex(K u, V d) {
     if (hasVertex(u)) { values[u] = d; return; }
     if (u >= span()) respan(u+1);
-    exists[u] = true;
+    markDirty(u);
+    setVertex(u);
     values[u] = d;
+    ++threadDirtyOrder();
   }
 
   /**
@@ -330,13 +614,16 @@ class DiGraph {
    * @param v target vertex id
    * @param w associated weight of the edge
    * @param ft test function (source vertex id)
+   * @note The source and target vertices are added, if missing, only where
+   * the test passes (i.e., by the thread that owns them).
    */
   template <class FT>
   inline void addEdgeIf(K u, K v, E w, FT ft) {
-    addVertex(u);
-    addVertex(v);
-    if (ft(u)) edges[u].add(v, w);
-    if (ft(v)) edges_rev[v].add(u,w);
+    if (ft(u)) { addVertex(u); markDirty(u); edges[u].add(v, w); }
+    if (ft(v)) {
+      addVertex(v);
+      if constexpr (REV) { markDirty(v); edges_rev[v].add(u,w); }
+    }
   }
 
   /**
@@ -360,8 +647,8 @@ class DiGraph {
   template <class FT>
   inline void removeEdgeIf(K u, K v, FT ft) {
     if (!hasVertex(u) || !hasVertex(v)) return;
-    if (ft(u)) edges[u].remove(v);
-    if (ft(v)) edges_rev[v].remove(u);
+    if (ft(u)) { markDirty(u); edges[u].remove(v); }
+    if constexpr (REV) { if (ft(v)) { markDirty(v); edges_rev[v].remove(u); } }
   }
 
   /**
@@ -382,9 +669,11 @@ class DiGraph {
    */
   inline void removeVertex(K u) {
     if (!hasVertex(u)) return;
-    exists[u] = false;
+    markDirty(u);
+    unsetVertex(u);
     values[u] = V();
     edges[u].clear();
+    --threadDirtyOrder();
   }
   #pragma endregion
   #pragma endregion
@@ -498,6 +787,32 @@ class DiGraphCsr {
       fp(u);
   }
 
+  #ifdef OPENMP
+  /**
+   * Iterate over the vertices in the graph, in parallel.
+   * @param fp process function (vertex id, vertex data), called from multiple threads
+   */
+  template <class FP>
+  inline void forEachVertexOmp(FP fp) const noexcept {
+    size_t S = span();
+    #pragma omp parallel for schedule(static, 2048)
+    for (K u=0; u<S; ++u)
+      fp(u, values[u]);
+  }
+
+  /**
+   * Iterate over the vertex ids in the graph, in parallel.
+   * @param fp process function (vertex id), called from multiple threads
+   */
+  template <class FP>
+  inline void forEachVertexKeyOmp(FP fp) const noexcept {
+    size_t S = span();
+    #pragma omp parallel for schedule(static, 2048)
+    for (K u=0; u<S; ++u)
+      fp(u);
+  }
+  #endif
+
   /**
    * Iterate over the outgoing edges of a source vertex in the graph.
    * @param u source vertex id
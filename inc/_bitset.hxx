@@ -5,6 +5,7 @@
 #include <cstdint>
 #include "_algorithm.hxx"
 #include "_ctypes.hxx"
+#include "_vector.hxx"
 
 using std::pair;
 using std::vector;
@@ -20,8 +21,9 @@ using std::lower_bound;
  * and deletions upon calling update(). It maintains keys in ascending order.
  * @tparam K key type
  * @tparam V value type
+ * @tparam C number of entries stored inline, before spilling to the heap
  */
-template <class K=uint32_t, class V=NONE>
+template <class K=uint32_t, class V=NONE, size_t C=3>
 class LazyBitset {
   #pragma region TYPES
   public:
@@ -36,10 +38,10 @@ class LazyBitset {
 
   #pragma region DATA
   protected:
-  /** The pairs of keys and values. */
-  vector<pair<K, V>> pairs;
+  /** The pairs of keys and values (a few inline, as most keys have few entries). */
+  SmallVector<pair<K, V>, C> pairs;
   /** The number of unprocessed insertions and deletions (-ve). */
-  ssize_t unprocessed;
+  ssize_t unprocessed = 0;
   #pragma endregion
 
 
@@ -250,8 +252,8 @@ class LazyBitset {
     size_t need  = unprocessed + 4;
     if (!buf)  pairs.resize(N + need);
     else if (buf->size() < need) buf->resize(need);
-    auto bb = buf? buf->begin() : pairs.begin() + N;
-    auto be = buf? buf->end()   : pairs.end();
+    auto bb = buf? buf->data() : pairs.begin() + N;
+    auto be = buf? buf->data() + buf->size() : pairs.end();
     auto ib = pairs.begin();
     auto im = ib + n;
     auto ie = ib + N;
@@ -278,6 +280,17 @@ class LazyBitset {
     unprocessed = 0;
   }
 
+  /**
+   * Replace all entries with the given ones.
+   * @param ib begin of entries (sorted by key, unique)
+   * @param ie end of entries
+   */
+  template <class I>
+  inline void assign(I ib, I ie) {
+    pairs.assign(ib, ie);
+    unprocessed = 0;
+  }
+
   /**
    * Update the bitset by sorting out all unprocessed insertions and deletions.
    * @note This is an expensive operation.
@@ -340,11 +353,12 @@ void writeBitset(ostream& a, const B& x) {
  * Write a lazy bitset to a stream.
  * @tparam K key type
  * @tparam V value type
+ * @tparam C number of entries stored inline
  * @param a stream
  * @param x bitset
  */
-template <class K, class V>
-inline void write(ostream& a, const LazyBitset<K, V>& x) {
+template <class K, class V, size_t C>
+inline void write(ostream& a, const LazyBitset<K, V, C>& x) {
   writeBitset(a, x);
 }
 
@@ -352,11 +366,12 @@ inline void write(ostream& a, const LazyBitset<K, V>& x) {
  * Write a lazy bitset to a stream.
  * @tparam K key type
  * @tparam V value type
+ * @tparam C number of entries stored inline
  * @param a stream
  * @param x bitset
  */
-template <class K, class V>
-inline ostream& operator<<(ostream& a, const LazyBitset<K, V>& x) {
+template <class K, class V, size_t C>
+inline ostream& operator<<(ostream& a, const LazyBitset<K, V, C>& x) {
   write(a, x);
   return a;
 }
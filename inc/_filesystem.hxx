@@ -0,0 +1,84 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <glob.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+using std::string;
+using std::vector;
+using std::sort;
+
+
+
+
+#pragma region METHODS
+#pragma region PATH
+/**
+ * Check if a path refers to a directory.
+ * @param pth path
+ * @returns is it a directory?
+ */
+inline bool isDirectory(const char *pth) {
+  struct stat st;
+  return stat(pth, &st)==0 && S_ISDIR(st.st_mode);
+}
+
+
+/**
+ * Check if a path refers to a regular file.
+ * @param pth path
+ * @returns is it a regular file?
+ */
+inline bool isRegularFile(const char *pth) {
+  struct stat st;
+  return stat(pth, &st)==0 && S_ISREG(st.st_mode);
+}
+
+
+/**
+ * Check if a path is a glob pattern.
+ * @param pth path
+ * @returns does it have any of the wildcards *, ? or [?
+ */
+inline bool isGlobPattern(const string& pth) {
+  return pth.find_first_of("*?[")!=string::npos;
+}
+
+
+/**
+ * Expand a path into the files it refers to.
+ * @param pth path to a file, a directory, or a glob pattern
+ * @returns the regular (non-hidden) files in a directory, or the files
+ * matching a glob pattern, in sorted order; or else the path itself
+ * @note An existing file or directory is taken as is, even if its name has
+ * wildcards (such as graph[1].txt).
+ */
+inline vector<string> expandPath(const string& pth) {
+  vector<string> a;
+  if (isDirectory(pth.c_str())) {
+    DIR *dir = opendir(pth.c_str());
+    if (!dir) return a;
+    string base = pth.back()=='/'? pth : pth + "/";
+    while (struct dirent *e = readdir(dir)) {
+      if (e->d_name[0]=='.') continue;
+      string file = base + e->d_name;
+      if (isRegularFile(file.c_str())) a.push_back(file);
+    }
+    closedir(dir);
+    sort(a.begin(), a.end());
+  }
+  else if (isGlobPattern(pth) && !isRegularFile(pth.c_str())) {
+    glob_t g;
+    if (glob(pth.c_str(), 0, nullptr, &g)==0) {
+      for (size_t i=0; i<g.gl_pathc; ++i)
+        if (isRegularFile(g.gl_pathv[i])) a.push_back(g.gl_pathv[i]);
+    }
+    globfree(&g);
+  }
+  else a.push_back(pth);
+  return a;
+}
+#pragma endregion
+#pragma endregion
@@ -2,17 +2,33 @@
 #include <utility>
 #include <type_traits>
 #include <iterator>
+#include <algorithm>
 #include <array>
 #include <vector>
+#include <string>
+#include <streambuf>
 #include <ostream>
+#include <istream>
 #include <iostream>
+#include <future>
+#include <functional>
 #include <chrono>
 #include <ctime>
 
 using std::pair;
+using std::min;
 using std::array;
 using std::vector;
+using std::string;
+using std::streambuf;
+using std::streamsize;
 using std::ostream;
+using std::istream;
+using std::future;
+using std::async;
+using std::launch;
+using std::ref;
+using std::getline;
 using std::is_fundamental;
 using std::iterator_traits;
 using std::time_t;
@@ -131,6 +147,121 @@ inline ostream& operator<<(ostream& a, const vector<T>& x) {
 
 
 
+#pragma region CLASSES
+#ifndef WRITE_BLOCK_BYTES
+/** Default number of bytes in a block, for block stream buffers. */
+#define WRITE_BLOCK_BYTES 4194304
+#endif
+
+
+/**
+ * A stream buffer that keeps written text in memory, as a list of blocks.
+ * @note Unlike a stringbuf, text that is already written is never moved, and
+ * blocks are kept (with their capacity) when the buffer is cleared, so that
+ * the buffer can be reused without allocating again.
+ */
+class BlockStreamBuffer : public streambuf {
+  #pragma region DATA
+  protected:
+  /** Blocks of written text. */
+  vector<string> blocks;
+  /** Number of blocks in use. */
+  size_t used = 0;
+  /** Capacity of each block. */
+  const size_t block;
+  #pragma endregion
+
+
+  #pragma region METHODS
+  #pragma region WRITE
+  protected:
+  /**
+   * Write characters to the buffer.
+   * @param s the characters
+   * @param n number of characters
+   * @returns number of characters written
+   */
+  streamsize xsputn(const char *s, streamsize n) override {
+    for (streamsize i=0; i<n;) {
+      if (used==0 || blocks[used-1].size()==block) {
+        if (used==blocks.size()) { blocks.emplace_back(); blocks.back().reserve(block); }
+        ++used;
+      }
+      string& b = blocks[used-1];
+      size_t m = min(size_t(n-i), block - b.size());
+      b.append(s+i, m);
+      i += m;
+    }
+    return n;
+  }
+
+  /**
+   * Write a character to the buffer.
+   * @param c the character
+   * @returns the character, or eof
+   */
+  int_type overflow(int_type c) override {
+    if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+    char x = traits_type::to_char_type(c);
+    xsputn(&x, 1);
+    return c;
+  }
+  #pragma endregion
+
+
+  #pragma region PROPERTIES
+  public:
+  /**
+   * Get the number of characters in the buffer.
+   * @returns the size
+   */
+  inline size_t size() const {
+    size_t a = 0;
+    for (size_t i=0; i<used; ++i)
+      a += blocks[i].size();
+    return a;
+  }
+  #pragma endregion
+
+
+  #pragma region UPDATE
+  public:
+  /**
+   * Remove all characters from the buffer, keeping its blocks.
+   */
+  inline void clear() {
+    for (size_t i=0; i<used; ++i)
+      blocks[i].clear();
+    used = 0;
+  }
+
+  /**
+   * Write all characters in the buffer to a stream.
+   * @param a the stream
+   */
+  inline void writeTo(ostream& a) const {
+    for (size_t i=0; i<used; ++i)
+      a.write(blocks[i].data(), blocks[i].size());
+  }
+  #pragma endregion
+  #pragma endregion
+
+
+  #pragma region CONSTRUCTORS
+  public:
+  /**
+   * Construct an empty block stream buffer.
+   * @param block capacity of each block
+   */
+  BlockStreamBuffer(size_t block=WRITE_BLOCK_BYTES) :
+  block(block? block : 1) {}
+  #pragma endregion
+};
+#pragma endregion
+
+
+
+
 #pragma region WRITE TIME
 /**
  * Write a time to a stream.
@@ -216,3 +347,41 @@ inline void println() {
   cout << "\n";
 }
 #pragma endregion
+
+
+
+
+#pragma region READ
+#ifndef READ_BLOCK_LINES
+/** Default number of lines in a block, for blocked stream readers. */
+#define READ_BLOCK_LINES 131072
+#endif
+
+
+/**
+ * Read lines from a stream in blocks, and process each block.
+ * @param s the stream
+ * @param size maximum number of lines to read
+ * @param block number of lines in each block
+ * @param fp process function (lines, number of lines)
+ * @note Blocks are double-buffered: a reader thread fills the next block while
+ * the current one is being processed, so that the stream is never left idle.
+ */
+template <class FP>
+inline void readLinesAsyncDo(istream& s, size_t size, size_t block, FP fp) {
+  vector<string> buf[2] = {vector<string>(block), vector<string>(block)};
+  auto fr = [&](vector<string>& lines) {
+    size_t n = 0;
+    for (; size>0 && n<block; ++n, --size)
+      if (!getline(s, lines[n])) break;
+    return n;
+  };
+  future<size_t> next = async(launch::async, fr, ref(buf[0]));
+  for (int b=0;; b^=1) {
+    size_t n = next.get();
+    if (n==0) break;
+    next = async(launch::async, fr, ref(buf[b^1]));
+    fp(buf[b], n);
+  }
+}
+#pragma endregion
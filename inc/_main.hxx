@@ -6,6 +6,8 @@
 #include "_iostream.hxx"
 #include "_iterator.hxx"
 #include "_string.hxx"
+#include "_mman.hxx"
+#include "_filesystem.hxx"
 #include "_utility.hxx"
 #include "_random.hxx"
 #include "_vector.hxx"
@@ -0,0 +1,136 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include <cstddef>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using std::string;
+using std::string_view;
+using std::runtime_error;
+
+
+
+
+#pragma region CLASSES
+/**
+ * A read-only memory mapping of a file.
+ */
+class MappedFile {
+  #pragma region DATA
+  protected:
+  /** File descriptor. */
+  int fd = -1;
+  /** Address of the mapping. */
+  void *addr = nullptr;
+  /** Size of the mapping (file size). */
+  size_t bytes = 0;
+  #pragma endregion
+
+
+  #pragma region METHODS
+  #pragma region PROPERTIES
+  public:
+  /**
+   * Get the mapped contents of the file.
+   * @returns mapped data
+   */
+  inline const char* data() const noexcept {
+    return (const char*) addr;
+  }
+
+  /**
+   * Get the size of the mapped file.
+   * @returns size in bytes
+   */
+  inline size_t size() const noexcept {
+    return bytes;
+  }
+
+  /**
+   * Get the mapped contents of the file as a string view.
+   * @returns mapped data
+   */
+  inline string_view view() const noexcept {
+    return string_view(data(), size());
+  }
+  #pragma endregion
+
+
+  #pragma region ADVISE
+  public:
+  /**
+   * Advise the kernel that the mapping will be accessed sequentially.
+   * @note Each thread still reads a contiguous range, so read-ahead helps.
+   */
+  inline void adviseSequential() const noexcept {
+    if (bytes) madvise(addr, bytes, MADV_SEQUENTIAL);
+  }
+
+  /**
+   * Advise the kernel that the mapping will be needed soon.
+   */
+  inline void adviseWillNeed() const noexcept {
+    if (bytes) madvise(addr, bytes, MADV_WILLNEED);
+  }
+  #pragma endregion
+
+
+  #pragma region UPDATE
+  public:
+  /**
+   * Unmap the file, and close its descriptor.
+   */
+  inline void close() noexcept {
+    if (addr) munmap(addr, bytes);
+    if (fd>=0) ::close(fd);
+    fd = -1; addr = nullptr; bytes = 0;
+  }
+
+  /**
+   * Map a file into memory (read-only).
+   * @param pth path to file
+   * @throws runtime_error if the file cannot be opened or mapped
+   */
+  inline void open(const char *pth) {
+    close();
+    fd = ::open(pth, O_RDONLY);
+    if (fd<0) throw runtime_error(string("Failed to open file: ") + pth);
+    struct stat st;
+    if (fstat(fd, &st)<0) { close(); throw runtime_error(string("Failed to stat file: ") + pth); }
+    bytes = size_t(st.st_size);
+    if (bytes==0) return;  // Cannot map an empty file.
+    addr  = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr==MAP_FAILED) { addr = nullptr; close(); throw runtime_error(string("Failed to map file: ") + pth); }
+  }
+  #pragma endregion
+  #pragma endregion
+
+
+  #pragma region CONSTRUCTORS
+  public:
+  /**
+   * Create an empty mapping.
+   */
+  MappedFile() {}
+
+  /**
+   * Map a file into memory (read-only).
+   * @param pth path to file
+   */
+  MappedFile(const char *pth) { open(pth); }
+
+  // A mapping cannot be shared.
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /**
+   * Unmap the file.
+   */
+  ~MappedFile() { close(); }
+  #pragma endregion
+};
+#pragma endregion
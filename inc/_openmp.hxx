@@ -5,6 +5,20 @@
 
 
 #pragma region BELONGS
+/**
+ * Find the thread that owns a work key.
+ * @param key work key
+ * @param THREADS available threads
+ * @returns owner thread
+ */
+template <class K>
+inline int ownerOmp(K key, int THREADS) {
+  const K CHUNK_SIZE = 1024;
+  K chunk = key / CHUNK_SIZE;
+  return int(chunk % THREADS);
+}
+
+
 /**
  * Check if work belongs to current thread.
  * @param key work key
@@ -14,9 +28,7 @@
  */
 template <class K>
 inline bool belongsOmp(K key, int thread, int THREADS) {
-  const K CHUNK_SIZE = 1024;
-  K chunk = key / CHUNK_SIZE;
-  return chunk % THREADS == thread;
+  return ownerOmp(key, THREADS) == thread;
 }
 
 
@@ -1,8 +1,17 @@
 #pragma once
 #include <iterator>
 #include <cstdint>
+#include <utility>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
 
 using std::iterator_traits;
+using std::move;
+using std::deque;
+using std::mutex;
+using std::unique_lock;
+using std::condition_variable;
 
 
 
@@ -280,4 +289,104 @@ template <class I>
 inline auto unsized_deque_view(I xb, I xe) {
   return UnsizedDequeView<I>(xb, xe);
 }
+
+
+
+
+/**
+ * A bounded queue, for handing off values between threads.
+ * @tparam T value type
+ * @note Producers block while the queue is full, and consumers block while it
+ * is empty, until it is closed.
+ */
+template <class T>
+class BlockingQueue {
+  #pragma region TYPES
+  public:
+  /** Value type of the queue. */
+  using value_type = T;
+  #pragma endregion
+
+
+  #pragma region DATA
+  protected:
+  /** Values in the queue. */
+  deque<T> values;
+  /** Maximum number of values in the queue. */
+  const size_t capacity;
+  /** Has the queue been closed? */
+  bool closed = false;
+  /** Guards the queue. */
+  mutable mutex guard;
+  /** Signalled when a value is pushed, or the queue is closed. */
+  condition_variable notEmpty;
+  /** Signalled when a value is popped. */
+  condition_variable notFull;
+  #pragma endregion
+
+
+  #pragma region METHODS
+  #pragma region SIZE
+  public:
+  /**
+   * Get the size of the queue.
+   * @returns the size
+   */
+  inline size_t size() const {
+    unique_lock<mutex> lock(guard);
+    return values.size();
+  }
+  #pragma endregion
+
+
+  #pragma region WRITE
+  public:
+  /**
+   * Push a value to the back of the queue, waiting while it is full.
+   * @param v the value (moved)
+   */
+  inline void push(T&& v) {
+    unique_lock<mutex> lock(guard);
+    notFull.wait(lock, [&]() { return values.size() < capacity; });
+    values.push_back(move(v));
+    notEmpty.notify_one();
+  }
+
+  /**
+   * Pop a value from the front of the queue, waiting while it is empty.
+   * @param v the value (output)
+   * @returns false if the queue is closed and empty, else true
+   */
+  inline bool pop(T& v) {
+    unique_lock<mutex> lock(guard);
+    notEmpty.wait(lock, [&]() { return !values.empty() || closed; });
+    if (values.empty()) return false;
+    v = move(values.front());
+    values.pop_front();
+    notFull.notify_one();
+    return true;
+  }
+
+  /**
+   * Close the queue, so that consumers stop once it is empty.
+   */
+  inline void close() {
+    unique_lock<mutex> lock(guard);
+    closed = true;
+    notEmpty.notify_all();
+  }
+  #pragma endregion
+  #pragma endregion
+
+
+  #pragma region CONSTRUCTORS
+  public:
+  /**
+   * Construct a bounded queue.
+   * @param capacity maximum number of values in the queue (at least 1)
+   */
+  BlockingQueue(size_t capacity) :
+  capacity(capacity? capacity : 1) {}
+  #pragma endregion
+};
 #pragma endregion
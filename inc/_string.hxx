@@ -1,9 +1,17 @@
 #pragma once
 #include <string>
 #include <cstdint>
+#include <cstring>
+#include <cmath>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 #include "_debug.hxx"
 
 using std::string;
+using std::pow;
+using std::memchr;
+using std::memcpy;
 
 
 
@@ -34,3 +42,224 @@ inline size_t countLines(const string& x) {
   return countLines(x.c_str());
 }
 #pragma endregion
+
+
+
+
+#pragma region PARSE
+/**
+ * Check if a character is a blank (space, tab or carriage return).
+ * @param c character
+ * @returns is it a blank?
+ */
+inline bool isBlank(char c) {
+  return c==' ' || c=='\t' || c=='\r';
+}
+
+
+/**
+ * Find the beginning of the next line.
+ * @param ib begin of text
+ * @param ie end of text
+ * @returns position after the next newline, or end of text
+ */
+inline const char* findNextLine(const char *ib, const char *ie) {
+  if (ib>=ie) return ie;
+  if (*ib=='\n') return ib+1;  // Usually at the end of a line already.
+  const char *it = (const char*) memchr(ib, '\n', ie-ib);  // Vectorized by libc.
+  return it? it+1 : ie;
+}
+
+
+/**
+ * Find the next non-blank character on the current line.
+ * @param ib begin of text
+ * @param ie end of text
+ * @returns position of the next non-blank character, or end of text
+ */
+inline const char* findNextNonBlank(const char *ib, const char *ie) {
+  for (; ib<ie && isBlank(*ib); ++ib);
+  return ib;
+}
+
+
+/**
+ * Find the first line that begins at or after a given position.
+ * @param ib begin of text
+ * @param ie end of text
+ * @param it given position
+ * @returns beginning of the line
+ * @note Used to split text into line-aligned ranges for each thread.
+ */
+inline const char* alignToLine(const char *ib, const char *ie, const char *it) {
+  if (it<=ib) return ib;
+  if (it>=ie) return ie;
+  if (*(it-1)=='\n') return it;
+  return findNextLine(it, ie);
+}
+
+
+/**
+ * Count the number of leading digits in text, upto 16.
+ * @param ib begin of text (at least 16 bytes readable)
+ * @returns number of leading digits
+ * @note All 16 bytes are classified at once, with SSE2 if available.
+ */
+inline int countDigits16(const char *ib) {
+#if defined(__SSE2__)
+  __m128i c = _mm_loadu_si128((const __m128i*) ib);
+  __m128i d = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0'-1)), _mm_cmplt_epi8(c, _mm_set1_epi8('9'+1)));
+  unsigned m = unsigned(_mm_movemask_epi8(d)) ^ 0xFFFFu;
+  return m? __builtin_ctz(m) : 16;
+#else
+  int n = 0;
+  for (; n<16 && unsigned(ib[n]-'0')<10; ++n);
+  return n;
+#endif
+}
+
+
+/**
+ * Convert upto 8 ASCII digits to a number, using SWAR arithmetic.
+ * @param ib begin of digits (at least 8 bytes readable)
+ * @param n number of digits [1, 8]
+ * @returns number
+ * @note Pairs, quads, and then octets of digits are combined, with one
+ * multiply each, instead of one multiply per digit. This needs the first digit
+ * in the lowest byte, so big-endian targets convert one digit at a time.
+ */
+inline uint64_t parseDigits8(const char *ib, int n) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  uint64_t x;
+  memcpy(&x, ib, 8);
+  x -= 0x3030303030303030ULL;
+  x <<= 8 * (8-n);  // Drop trailing non-digits (leading zeros take their place).
+  x = (x * 10    + (x >> 8))  & 0x00FF00FF00FF00FFULL;
+  x = (x * 100   + (x >> 16)) & 0x0000FFFF0000FFFFULL;
+  x = (x * 10000 + (x >> 32)) & 0x00000000FFFFFFFFULL;
+  return x;
+#else
+  uint64_t x = 0;
+  for (int i=0; i<n; ++i)
+    x = x*10 + uint64_t(ib[i]-'0');
+  return x;
+#endif
+}
+
+
+/** Powers of 10, that are exact in both uint64_t and double. */
+const uint64_t POW10[19] = {
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+  100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+  10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+  100000000000000000ULL, 1000000000000000000ULL
+};
+
+
+/**
+ * Read an unsigned integer from text.
+ * @param a read number (output)
+ * @param ib begin of text
+ * @param ie end of text
+ * @returns position after the number, or ib if there is no number
+ * @note Unlike strtoull, this does not need the text to be NUL-terminated.
+ * Numbers of upto 15 digits, with 16 bytes of text available, are converted
+ * in bulk (see countDigits16, parseDigits8).
+ */
+template <class T>
+inline const char* readUintW(T& a, const char *ib, const char *ie) {
+  if (ie-ib >= 16) {
+    int n = countDigits16(ib);
+    if (n==0) { a = T(); return ib; }
+    if (n<=8) { a = T(parseDigits8(ib, n)); return ib+n; }
+    if (n<16) { a = T(parseDigits8(ib, 8) * POW10[n-8] + parseDigits8(ib+8, n-8)); return ib+n; }
+  }
+  const char *it = ib;
+  T x = T();
+  for (; it<ie && unsigned(*it-'0')<10; ++it)
+    x = x*10 + T(*it-'0');
+  a = x;
+  return it;
+}
+
+
+/**
+ * Read a floating-point number from text, one digit at a time.
+ * @param a read number (output)
+ * @param ib begin of text
+ * @param ie end of text
+ * @returns position after the number, or ib if there is no number
+ * @note Rounding may differ from strtod in the last digit.
+ */
+inline const char* readFloatDigitsW(double& a, const char *ib, const char *ie) {
+  const char *it = ib;
+  bool neg = false;
+  if (it<ie && (*it=='-' || *it=='+')) neg = *it++=='-';
+  uint64_t m = 0;
+  int e = 0, digits = 0;
+  for (; it<ie && unsigned(*it-'0')<10; ++it, ++digits) {
+    if (m < 1000000000000000000ULL) m = m*10 + (*it-'0');
+    else ++e;
+  }
+  if (it<ie && *it=='.') {
+    for (++it; it<ie && unsigned(*it-'0')<10; ++it, ++digits)
+      if (m < 1000000000000000000ULL) { m = m*10 + (*it-'0'); --e; }
+  }
+  if (digits==0) { a = 0; return ib; }
+  if (it<ie && (*it=='e' || *it=='E')) {
+    int x = 0; bool xneg = false;
+    const char *ix = it+1;
+    if (ix<ie && (*ix=='-' || *ix=='+')) xneg = *ix++=='-';
+    const char *jx = readUintW(x, ix, ie);
+    if (jx>ix) { e += xneg? -x : x; it = jx; }
+  }
+  double x = double(m);
+  if (e!=0) x *= pow(10.0, e);
+  a = neg? -x : x;
+  return it;
+}
+
+
+/**
+ * Read a floating-point number from text.
+ * @param a read number (output)
+ * @param ib begin of text
+ * @param ie end of text
+ * @returns position after the number, or ib if there is no number
+ * @note Integer and fraction digits are read in bulk (see readUintW), and
+ * scaled by an exact power of 10 where possible. Numbers with more than 18
+ * significant digits fall back to readFloatDigitsW. Rounding may differ from
+ * strtod in the last digit.
+ */
+inline const char* readFloatW(double& a, const char *ib, const char *ie) {
+  const char *it = ib;
+  bool neg = false;
+  if (it<ie && (*it=='-' || *it=='+')) neg = *it++=='-';
+  uint64_t m = 0, f = 0;
+  const char *jm = readUintW(m, it, ie);
+  int digits = int(jm - it), e = 0;
+  if (digits>18) return readFloatDigitsW(a, ib, ie);
+  it = jm;
+  if (it<ie && *it=='.') {
+    const char *jf = readUintW(f, it+1, ie);
+    int n = int(jf - (it+1));
+    if (digits+n>18) return readFloatDigitsW(a, ib, ie);
+    m = m * POW10[n] + f;
+    digits += n; e = -n; it = jf;
+  }
+  if (digits==0) { a = 0; return ib; }
+  if (it<ie && (*it=='e' || *it=='E')) {
+    int x = 0; bool xneg = false;
+    const char *ix = it+1;
+    if (ix<ie && (*ix=='-' || *ix=='+')) xneg = *ix++=='-';
+    const char *jx = readUintW(x, ix, ie);
+    if (jx>ix) { e += xneg? -x : x; it = jx; }
+  }
+  double x = double(m);
+  if      (e<0 && e>=-18) x /= double(POW10[-e]);
+  else if (e>0 && e<= 18) x *= double(POW10[e]);
+  else if (e!=0) x *= pow(10.0, e);
+  a = neg? -x : x;
+  return it;
+}
+#pragma endregion
@@ -1,4 +1,8 @@
 #pragma once
+#include <new>
+#include <memory>
+#include <iterator>
+#include <type_traits>
 #include <vector>
 #include <algorithm>
 #include <cstdint>
@@ -9,6 +13,11 @@
 #endif
 
 using std::vector;
+using std::is_trivially_destructible_v;
+using std::uninitialized_copy;
+using std::uninitialized_move;
+using std::uninitialized_value_construct;
+using std::distance;
 using std::fill;
 using std::abs;
 using std::min;
@@ -29,6 +38,272 @@ using vector2d = vector<vector<T>>;
 
 
 
+#pragma region CLASSES
+/**
+ * A vector that stores up to C elements inline, and spills to the heap
+ * only when it grows beyond that.
+ * @tparam T element type (trivially destructible)
+ * @tparam C number of elements stored inline
+ * @note Iterators are pointers, and are invalidated by growth (like vector).
+ */
+template <class T, size_t C>
+class SmallVector {
+  static_assert(is_trivially_destructible_v<T>, "SmallVector needs a trivially destructible element type.");
+  static_assert(C > 0, "SmallVector needs space for at least one inline element.");
+
+  #pragma region TYPES
+  public:
+  /** Value type of the vector. */
+  using value_type = T;
+  #pragma endregion
+
+
+  #pragma region DATA
+  protected:
+  union {
+    /** Heap storage, if capacity exceeds C. */
+    T *ptr;
+    /** Inline storage, if capacity is C. */
+    alignas(T) unsigned char buf[C * sizeof(T)];
+  };
+  /** Number of elements. */
+  uint32_t n = 0;
+  /** Number of elements that fit without growing (C, if inline). */
+  uint32_t cap = uint32_t(C);
+  #pragma endregion
+
+
+  #pragma region METHODS
+  #pragma region HELPERS
+  protected:
+  /**
+   * Check if the elements are stored inline.
+   * @returns is storage inline?
+   */
+  inline bool isInline() const noexcept {
+    return cap <= C;
+  }
+
+  /**
+   * Move the elements to heap storage of given capacity.
+   * @param m new capacity (at least the size)
+   */
+  inline void reallocate(size_t m) {
+    T *p = static_cast<T*>(::operator new(m * sizeof(T)));
+    uninitialized_move(begin(), end(), p);
+    if (!isInline()) ::operator delete(ptr);
+    ptr = p;
+    cap = uint32_t(m);
+  }
+
+  /**
+   * Take the elements of another vector, stealing its heap storage if any.
+   * @param x vector to take from (left empty)
+   * @note This vector must be empty, and inline.
+   */
+  inline void take(SmallVector& x) noexcept {
+    if (x.isInline()) uninitialized_move(x.begin(), x.end(), begin());
+    else { ptr = x.ptr; cap = x.cap; x.cap = uint32_t(C); }
+    n = x.n; x.n = 0;
+  }
+  #pragma endregion
+
+
+  #pragma region SIZE
+  public:
+  /**
+   * Get the number of elements.
+   * @returns |this|
+   */
+  inline size_t size() const noexcept {
+    return n;
+  }
+
+  /**
+   * Check if the vector is empty.
+   * @returns |this| == 0
+   */
+  inline bool empty() const noexcept {
+    return n == 0;
+  }
+
+  /**
+   * Get the number of elements that fit without growing.
+   * @returns capacity
+   */
+  inline size_t capacity() const noexcept {
+    return cap;
+  }
+  #pragma endregion
+
+
+  #pragma region ITERATOR
+  public:
+  /**
+   * Get pointer to the first element.
+   * @returns & this[0]
+   */
+  inline T* begin() noexcept {
+    return isInline()? reinterpret_cast<T*>(buf) : ptr;
+  }
+
+  /**
+   * Get const pointer to the first element.
+   * @returns const& this[0]
+   */
+  inline const T* begin() const noexcept {
+    return isInline()? reinterpret_cast<const T*>(buf) : ptr;
+  }
+
+  /**
+   * Get pointer to the end.
+   * @returns & this[|this|]
+   */
+  inline T* end() noexcept {
+    return begin() + n;
+  }
+
+  /**
+   * Get const pointer to the end.
+   * @returns const& this[|this|]
+   */
+  inline const T* end() const noexcept {
+    return begin() + n;
+  }
+
+  /**
+   * Get the element at given index.
+   * @param i index
+   * @returns this[i]
+   */
+  inline T& operator[](size_t i) noexcept {
+    return begin()[i];
+  }
+
+  /**
+   * Get the element at given index.
+   * @param i index
+   * @returns this[i]
+   */
+  inline const T& operator[](size_t i) const noexcept {
+    return begin()[i];
+  }
+  #pragma endregion
+
+
+  #pragma region UPDATE
+  public:
+  /**
+   * Reserve space for m elements.
+   * @param m number of elements
+   */
+  inline void reserve(size_t m) {
+    if (m > cap) reallocate(m);
+  }
+
+  /**
+   * Change the number of elements, value-initializing new ones.
+   * @param m number of elements
+   */
+  inline void resize(size_t m) {
+    if (m > cap) reallocate(max(m, 2 * size_t(cap)));
+    if (m > n) uninitialized_value_construct(begin() + n, begin() + m);
+    n = uint32_t(m);
+  }
+
+  /**
+   * Add an element to the end.
+   * @param v element
+   */
+  inline void push_back(const T& v) {
+    if (n == cap) reallocate(2 * size_t(cap));
+    ::new (static_cast<void*>(end())) T(v);
+    ++n;
+  }
+
+  /**
+   * Remove all elements, keeping the capacity.
+   */
+  inline void clear() noexcept {
+    n = 0;
+  }
+
+  /**
+   * Replace all elements with the given ones.
+   * @param ib begin of elements
+   * @param ie end of elements
+   */
+  template <class I>
+  inline void assign(I ib, I ie) {
+    size_t m = distance(ib, ie);
+    n = 0;
+    if (m > cap) reallocate(m);
+    uninitialized_copy(ib, ie, begin());
+    n = uint32_t(m);
+  }
+  #pragma endregion
+  #pragma endregion
+
+
+  #pragma region CONSTRUCTORS
+  public:
+  /**
+   * Construct an empty vector.
+   */
+  SmallVector() noexcept {}
+
+  /**
+   * Copy a vector.
+   * @param x vector to copy
+   */
+  SmallVector(const SmallVector& x) {
+    assign(x.begin(), x.end());
+  }
+
+  /**
+   * Move a vector, stealing its heap storage if any.
+   * @param x vector to move (left empty)
+   */
+  SmallVector(SmallVector&& x) noexcept {
+    take(x);
+  }
+
+  /**
+   * Copy a vector.
+   * @param x vector to copy
+   * @returns this
+   */
+  SmallVector& operator=(const SmallVector& x) {
+    if (this != &x) assign(x.begin(), x.end());
+    return *this;
+  }
+
+  /**
+   * Move a vector, stealing its heap storage if any.
+   * @param x vector to move (left empty)
+   * @returns this
+   */
+  SmallVector& operator=(SmallVector&& x) noexcept {
+    if (this == &x) return *this;
+    if (!isInline()) ::operator delete(ptr);
+    n = 0; cap = uint32_t(C);
+    take(x);
+    return *this;
+  }
+
+  /**
+   * Destroy the vector, releasing its heap storage if any.
+   */
+  ~SmallVector() {
+    if (!isInline()) ::operator delete(ptr);
+  }
+  #pragma endregion
+};
+#pragma endregion
+
+
+
+
 #pragma region METHODS
 #pragma region GATHER VALUES
 /**
@@ -3,8 +3,11 @@
 #include <random>
 #include <numeric>
 #include <algorithm>
+#include <charconv>
+#include <ostream>
 #include "_main.hxx"
 #include "update.hxx"
+#include "mtx.hxx"
 #include "muParser.h"
 
 using std::tuple;
@@ -14,9 +17,14 @@ using std::uniform_int_distribution;
 using std::discrete_distribution;
 using std::runtime_error;
 using std::make_tuple;
+using std::get;
 using std::sort;
 using std::unique;
 using std::remove_if;
+using std::min;
+using std::ostream;
+using std::to_chars;
+using std::is_same_v;
 using std::exp;
 using std::log;
 using mu::Parser;
@@ -256,6 +264,198 @@ inline void applyBatchUpdateOmpU(G& a, const vector<tuple<K, K, V>>& deletions,
 }
 #endif
 #pragma endregion
+
+
+
+
+#pragma region PARTITION BATCH
+/**
+ * Partition the edges of a batch update into shards, by source vertex.
+ * @param a edges in each shard (output, sized to the number of shards)
+ * @param edges edges in batch update
+ * @param fs shard of a source vertex (u)
+ * @note Edges keep their order within each shard.
+ */
+template <class K, class V, class FS>
+inline void partitionBatchW(vector<vector<tuple<K, K, V>>>& a, const vector<tuple<K, K, V>>& edges, FS fs) {
+  for (auto& shard : a)
+    shard.clear();
+  for (const auto& e : edges)
+    a[fs(get<0>(e))].push_back(e);
+}
+
+
+#ifdef OPENMP
+/**
+ * Partition the edges of a batch update into shards, by source vertex, in parallel.
+ * @param a edges in each shard (output, sized to the number of shards)
+ * @param edges edges in batch update
+ * @param fs shard of a source vertex (u)
+ * @note Each thread counts the edges of its range into per-shard buckets, and
+ * then scatters them to its slice of each shard, so that edges keep their
+ * order within each shard (as with partitionBatchW()).
+ */
+template <class K, class V, class FS>
+inline void partitionBatchOmpW(vector<vector<tuple<K, K, V>>>& a, const vector<tuple<K, K, V>>& edges, FS fs) {
+  size_t N = a.size(), E = edges.size();
+  int    T = omp_get_max_threads();
+  vector<size_t> offsets(T * N);
+  #pragma omp parallel num_threads(T)
+  {
+    int    t  = omp_get_thread_num(), U = omp_get_num_threads();
+    size_t ib = E * t / U, ie = E * (t+1) / U;
+    size_t *bucket = offsets.data() + t * N;
+    for (size_t i=ib; i<ie; ++i)
+      ++bucket[fs(get<0>(edges[i]))];
+    #pragma omp barrier
+    #pragma omp single
+    for (size_t s=0; s<N; ++s) {
+      size_t n = 0;
+      for (int r=0; r<U; ++r) {
+        size_t c = offsets[r*N + s];
+        offsets[r*N + s] = n;
+        n += c;
+      }
+      a[s].resize(n);
+    }
+    for (size_t i=ib; i<ie; ++i) {
+      size_t s = fs(get<0>(edges[i]));
+      a[s][bucket[s]++] = edges[i];
+    }
+  }
+}
+#endif
+#pragma endregion
+
+
+
+
+#pragma region WRITE BATCH
+/**
+ * Format edges of a batch update as lines (u, v, [w]).
+ * @param it output position (128 bytes writable per edge)
+ * @param ib begin of edges
+ * @param ie end of edges
+ * @param weighted write edge weights?
+ * @returns position after the characters formatted
+ */
+template <class K, class V>
+inline char* formatBatchEdges(char *it, const tuple<K, K, V> *ib, const tuple<K, K, V> *ie, bool weighted) {
+  char *end = it + 128 * (ie-ib);
+  for (; ib<ie; ++ib) {
+    const auto& [u, v, w] = *ib;
+    it = to_chars(it, end, u).ptr; *(it++) = ' ';
+    it = to_chars(it, end, v).ptr;
+    if (weighted) { *(it++) = ' '; it = to_chars(it, end, w).ptr; }
+    *(it++) = '\n';
+  }
+  return it;
+}
+
+
+/**
+ * Write edges of a batch update as lines (u, v, [w]).
+ * @param a output stream
+ * @param edges edges in batch update
+ * @param weighted write edge weights?
+ * @note Numbers are formatted with to_chars into a buffer, which is written
+ * in large pieces.
+ */
+template <class K, class V>
+inline void writeBatchEdges(ostream& a, const vector<tuple<K, K, V>>& edges, bool weighted) {
+  const size_t LINE  = 128;  // Upper bound on the length of a line.
+  const size_t CHUNK = size_t(1) << 16;
+  size_t E = edges.size();
+  vector<char> buf(LINE * min(E, CHUNK));
+  for (size_t i=0; i<E; i+=CHUNK) {
+    const auto *ib = edges.data() + i, *ie = edges.data() + min(i+CHUNK, E);
+    a.write(buf.data(), formatBatchEdges(buf.data(), ib, ie, weighted) - buf.data());
+  }
+}
+
+
+#ifdef OPENMP
+/**
+ * Write edges of a batch update as lines (u, v, [w]), formatting them in parallel.
+ * @param a output stream
+ * @param edges edges in batch update
+ * @param weighted write edge weights?
+ * @note In each round, threads format a chunk of edges each into their own
+ * buffer, which are then written in order.
+ */
+template <class K, class V>
+inline void writeBatchEdgesOmp(ostream& a, const vector<tuple<K, K, V>>& edges, bool weighted) {
+  const int    T     = omp_get_max_threads();
+  const size_t LINE  = 128;  // Upper bound on the length of a line.
+  const size_t CHUNK = size_t(1) << 16;
+  size_t E = edges.size();
+  size_t C = (E + CHUNK - 1) / CHUNK;
+  vector<vector<char>> bufs(T);
+  vector<size_t> sizes(T);
+  for (size_t r=0; r<C; r+=T) {
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int t=0; t<T; ++t) {
+      size_t c = r + t;
+      if (c>=C) { sizes[t] = 0; continue; }
+      const auto *ib = edges.data() + c*CHUNK, *ie = edges.data() + min((c+1)*CHUNK, E);
+      bufs[t].resize(LINE * CHUNK);
+      sizes[t] = formatBatchEdges(bufs[t].data(), ib, ie, weighted) - bufs[t].data();
+    }
+    for (int t=0; t<T; ++t)
+      a.write(bufs[t].data(), sizes[t]);
+  }
+}
+#endif
+
+
+/**
+ * Write a batch update as a delta, with deletions followed by insertions.
+ * @param a output stream
+ * @param deletions edge deletions in batch update
+ * @param insertions edge insertions in batch update
+ * @param weighted write weights of inserted edges?
+ * @note Each section begins with a line "- D" or "+ I", where D and I are the
+ * number of edge deletions and insertions that follow. Deleted edges are
+ * written without weights.
+ */
+template <class K, class V>
+inline void writeBatchDelta(ostream& a, const vector<tuple<K, K, V>>& deletions, const vector<tuple<K, K, V>>& insertions, bool weighted=true) {
+  a << "- " << deletions.size() << "\n";
+  writeBatchEdges(a, deletions, false);
+  a << "+ " << insertions.size() << "\n";
+  writeBatchEdges(a, insertions, weighted);
+}
+
+
+/**
+ * Write edges of a batch update as an MTX file.
+ * @param a output stream
+ * @param edges edges in batch update
+ * @param rows number of rows and columns (span of vertex ids - 1)
+ * @param weighted write edge weights?
+ */
+template <class K, class V>
+inline void writeBatchMtx(ostream& a, const vector<tuple<K, K, V>>& edges, size_t rows, bool weighted=true) {
+  writeMtxHeader(a, false, mtxField<V>(weighted), rows, rows, edges.size());
+  writeBatchEdges(a, edges, weighted && !is_same_v<V, None>);
+}
+
+
+#ifdef OPENMP
+/**
+ * Write edges of a batch update as an MTX file, formatting them in parallel.
+ * @param a output stream
+ * @param edges edges in batch update
+ * @param rows number of rows and columns (span of vertex ids - 1)
+ * @param weighted write edge weights?
+ */
+template <class K, class V>
+inline void writeBatchMtxOmp(ostream& a, const vector<tuple<K, K, V>>& edges, size_t rows, bool weighted=true) {
+  writeMtxHeader(a, false, mtxField<V>(weighted), rows, rows, edges.size());
+  writeBatchEdgesOmp(a, edges, weighted && !is_same_v<V, None>);
+}
+#endif
+#pragma endregion
 #pragma endregion
 
 
@@ -1,10 +1,16 @@
 #pragma once
+#include <utility>
 #include <vector>
 #include <unordered_map>
+#include <algorithm>
 #include "_main.hxx"
+#include "Graph.hxx"
 
+using std::pair;
 using std::vector;
 using std::unordered_map;
+using std::sort;
+using std::unique;
 
 
 
@@ -284,6 +290,124 @@ inline void csrCreateEdgeValuesW(vector<E>& edgeValues, const G& x, const vector
     });
   }
 }
+
+
+/**
+ * Obtain the index of each vertex id, among the vertices in the graph.
+ * @param ids index of each vertex id, or -1 if it is not in the graph (output)
+ * @param x given graph
+ * @note Indices are the vertex ids used by the csrCreate*W() functions.
+ */
+template <class G, class K>
+inline void csrCreateVertexIdsW(vector<K>& ids, const G& x) {
+  size_t S = x.span();
+  K i = K();
+  ids.assign(S, K(-1));
+  x.forEachVertexKey([&](auto u) { ids[u] = i++; });
+}
+
+
+#ifdef OPENMP
+/**
+ * Obtain the index of each vertex id, among the vertices in the graph, in parallel.
+ * @param ids index of each vertex id, or -1 if it is not in the graph (output)
+ * @param x given graph
+ * @note Indices are the vertex ids used by the csrCreate*W() functions.
+ */
+template <class G, class K>
+inline void csrCreateVertexIdsOmpW(vector<K>& ids, const G& x) {
+  size_t S = x.span();
+  vector<K> exists(S), buf(omp_get_max_threads());
+  ids.resize(S);
+  x.forEachVertexKeyOmp([&](auto u) { exists[u] = 1; });
+  exclusiveScanOmpW(ids, buf, exists);
+  #pragma omp parallel for schedule(static, 2048)
+  for (size_t u=0; u<S; ++u)
+    if (!exists[u]) ids[u] = K(-1);
+}
+
+
+/**
+ * Obtain offsets of the outgoing edges of vertices, in parallel.
+ * @param offsets offsets of the outgoing edges of vertices (output)
+ * @param x given graph
+ */
+template <class G, class O>
+inline void csrCreateOffsetsOmpW(vector<O>& offsets, const G& x) {
+  using K = typename G::key_type;
+  size_t S = x.span(), N = x.order();
+  vector<K> ids;
+  vector<O> degrees(N), buf(omp_get_max_threads());
+  csrCreateVertexIdsOmpW(ids, x);
+  #pragma omp parallel for schedule(static, 2048)
+  for (size_t u=0; u<S; ++u)
+    if (ids[u]!=K(-1)) degrees[ids[u]] = x.degree(K(u));
+  offsets.resize(N+1);
+  offsets[N] = exclusiveScanOmpW(offsets.data(), buf.data(), degrees.data(), N);
+}
+
+
+/**
+ * Obtain degree of each vertex, in parallel.
+ * @param degrees degree of each vertex (output)
+ * @param x given graph
+ */
+template <class G, class K>
+inline void csrCreateDegreesOmpW(vector<K>& degrees, const G& x) {
+  size_t S = x.span(), N = x.order();
+  vector<K> ids;
+  csrCreateVertexIdsOmpW(ids, x);
+  degrees.resize(N);
+  #pragma omp parallel for schedule(static, 2048)
+  for (size_t u=0; u<S; ++u)
+    if (ids[u]!=K(-1)) degrees[ids[u]] = K(x.degree(K(u)));
+}
+
+
+/**
+ * Obtain vertex ids of the outgoing edges of each vertex, in parallel.
+ * @param edgeKeys vertex ids of the outgoing edges of each vertex (output)
+ * @param x given graph
+ */
+template <class G, class K>
+inline void csrCreateEdgeKeysOmpW(vector<K>& edgeKeys, const G& x) {
+  size_t S = x.span();
+  vector<K> ids;
+  vector<size_t> offsets;
+  csrCreateVertexIdsOmpW(ids, x);
+  csrCreateOffsetsOmpW(offsets, x);
+  edgeKeys.resize(offsets.back());
+  #pragma omp parallel for schedule(dynamic, 2048)
+  for (size_t u=0; u<S; ++u) {
+    if (ids[u]==K(-1)) continue;
+    size_t i = offsets[ids[u]];
+    x.forEachEdgeKey(K(u), [&](auto v) { edgeKeys[i++] = ids[v]; });
+  }
+}
+
+
+/**
+ * Obtain edge values of the outgoing edges of each vertex, in parallel.
+ * @param edgeValues edge values of the outgoing edges of each vertex (output)
+ * @param x given graph
+ */
+template <class G, class E>
+inline void csrCreateEdgeValuesOmpW(vector<E>& edgeValues, const G& x) {
+  using K = typename G::key_type;
+  size_t S = x.span();
+  vector<K> ids;
+  vector<size_t> offsets;
+  csrCreateVertexIdsOmpW(ids, x);
+  csrCreateOffsetsOmpW(offsets, x);
+  edgeValues.resize(offsets.back());
+  #pragma omp parallel for schedule(dynamic, 2048)
+  for (size_t u=0; u<S; ++u) {
+    if (ids[u]==K(-1)) continue;
+    size_t i = offsets[ids[u]];
+    x.forEachEdge(K(u), [&](auto v, auto w) { edgeValues[i++] = w; });
+  }
+}
+#endif
 #pragma endregion
 
 
@@ -414,4 +538,228 @@ inline void csrAddEdgeOmpU(vector<K>& degrees, vector<K>& edgeKeys, vector<E>& e
   edgeValues[i] = w;
 }
 #endif
+
+
+/**
+ * Sort the outgoing edges of a vertex, and remove duplicate edges.
+ * @param buf buffer for edges (scratch)
+ * @param degrees degree of each vertex (updated)
+ * @param edgeKeys vertex ids of the outgoing edges of each vertex (updated)
+ * @param edgeValues edge values of the outgoing edges of each vertex (updated)
+ * @param offsets offsets of the outgoing edges of vertices
+ * @param u source vertex id
+ * @note Of duplicate edges, the weight of any one is kept.
+ */
+template <class O, class K, class E>
+inline void csrSortEdgesU(vector<pair<K, E>>& buf, vector<K>& degrees, vector<K>& edgeKeys, vector<E>& edgeValues, const vector<O>& offsets, K u) {
+  O i = offsets[u];
+  O d = degrees[u];
+  buf.clear();
+  for (O j=i; j<i+d; ++j)
+    buf.push_back({edgeKeys[j], edgeValues[j]});
+  sort(buf.begin(), buf.end(), [](const auto& p, const auto& q) { return p.first < q.first; });
+  auto ie = unique(buf.begin(), buf.end(), [](const auto& p, const auto& q) { return p.first == q.first; });
+  degrees[u] = K(ie - buf.begin());
+  for (auto it=buf.begin(); it!=ie; ++it, ++i) {
+    edgeKeys[i]   = it->first;
+    edgeValues[i] = it->second;
+  }
+}
+
+
+/**
+ * Sort the outgoing edges of each vertex, and remove duplicate edges.
+ * @param degrees degree of each vertex (updated)
+ * @param edgeKeys vertex ids of the outgoing edges of each vertex (updated)
+ * @param edgeValues edge values of the outgoing edges of each vertex (updated)
+ * @param offsets offsets of the outgoing edges of vertices
+ * @note Removed edges leave gaps in the edge arrays, as offsets are unchanged.
+ */
+template <class O, class K, class E>
+inline void csrSortEdgesU(vector<K>& degrees, vector<K>& edgeKeys, vector<E>& edgeValues, const vector<O>& offsets) {
+  vector<pair<K, E>> buf;
+  for (size_t u=0; u<degrees.size(); ++u)
+    csrSortEdgesU(buf, degrees, edgeKeys, edgeValues, offsets, K(u));
+}
+
+#ifdef OPENMP
+/**
+ * Sort the outgoing edges of each vertex, and remove duplicate edges.
+ * @param degrees degree of each vertex (updated)
+ * @param edgeKeys vertex ids of the outgoing edges of each vertex (updated)
+ * @param edgeValues edge values of the outgoing edges of each vertex (updated)
+ * @param offsets offsets of the outgoing edges of vertices
+ * @note Removed edges leave gaps in the edge arrays, as offsets are unchanged.
+ */
+template <class O, class K, class E>
+inline void csrSortEdgesOmpU(vector<K>& degrees, vector<K>& edgeKeys, vector<E>& edgeValues, const vector<O>& offsets) {
+  size_t N = degrees.size();
+  #pragma omp parallel
+  {
+    vector<pair<K, E>> buf;
+    #pragma omp for schedule(dynamic, 2048)
+    for (size_t u=0; u<N; ++u)
+      csrSortEdgesU(buf, degrees, edgeKeys, edgeValues, offsets, K(u));
+  }
+}
+#endif
+#pragma endregion
+
+
+
+
+#pragma region GRAPH
+/**
+ * Obtain the CSR representation of a graph.
+ * @param a CSR graph (output)
+ * @param x given graph
+ * @note Vertices are renumbered from 0, in order of vertex id (see csrCreateVertexIdsW()).
+ */
+template <class K, class V, class E, class O, class G>
+inline void csrCreateGraphW(DiGraphCsr<K, V, E, O>& a, const G& x) {
+  csrCreateOffsetsW(a.offsets, x);
+  csrCreateDegreesW(a.degrees, x);
+  csrCreateEdgeKeysW(a.edgeKeys, x);
+  csrCreateEdgeValuesW(a.edgeValues, x);
+  a.values.resize(a.degrees.size());
+}
+
+
+#ifdef OPENMP
+/**
+ * Obtain the CSR representation of a graph, in parallel.
+ * @param a CSR graph (output)
+ * @param x given graph
+ * @note Vertices are renumbered from 0, in order of vertex id (see csrCreateVertexIdsOmpW()).
+ */
+template <class K, class V, class E, class O, class G>
+inline void csrCreateGraphOmpW(DiGraphCsr<K, V, E, O>& a, const G& x) {
+  csrCreateOffsetsOmpW(a.offsets, x);
+  csrCreateDegreesOmpW(a.degrees, x);
+  csrCreateEdgeKeysOmpW(a.edgeKeys, x);
+  csrCreateEdgeValuesOmpW(a.edgeValues, x);
+  a.values.resize(a.degrees.size());
+}
+#endif
+
+
+/**
+ * Obtain the transpose of a CSR graph.
+ * @param a transposed graph, with incoming edges sorted by source (output)
+ * @param x given CSR graph
+ */
+template <class K, class V, class E, class O>
+inline void csrTransposeW(DiGraphCsr<K, V, E, O>& a, const DiGraphCsr<K, V, E, O>& x) {
+  size_t N = x.order();
+  a.respan(N);
+  a.values = x.values;
+  fillValueU(a.degrees, K());
+  for (size_t u=0; u<N; ++u)
+    x.forEachEdgeKey(K(u), [&](auto v) { ++a.degrees[v]; });
+  a.offsets[N] = exclusiveScanW(a.offsets.data(), a.degrees.data(), N);
+  a.edgeKeys.resize(a.offsets[N]);
+  a.edgeValues.resize(a.offsets[N]);
+  fillValueU(a.degrees, K());
+  // Sources are visited in order, so incoming edges are already sorted.
+  for (size_t u=0; u<N; ++u)
+    x.forEachEdge(K(u), [&](auto v, auto w) { csrAddEdgeU(a.degrees, a.edgeKeys, a.edgeValues, a.offsets, v, K(u), w); });
+}
+
+
+#ifdef OPENMP
+/**
+ * Obtain the transpose of a CSR graph, in parallel.
+ * @param a transposed graph, with incoming edges sorted by source (output)
+ * @param x given CSR graph
+ */
+template <class K, class V, class E, class O>
+inline void csrTransposeOmpW(DiGraphCsr<K, V, E, O>& a, const DiGraphCsr<K, V, E, O>& x) {
+  size_t N = x.order();
+  vector<O> buf(omp_get_max_threads());
+  a.respan(N);
+  a.values = x.values;
+  fillValueOmpU(a.degrees, K());
+  #pragma omp parallel for schedule(dynamic, 2048)
+  for (size_t u=0; u<N; ++u) {
+    x.forEachEdgeKey(K(u), [&](auto v) {
+      #pragma omp atomic
+      ++a.degrees[v];
+    });
+  }
+  a.offsets[N] = exclusiveScanOmpW(a.offsets.data(), buf.data(), a.degrees.data(), N);
+  a.edgeKeys.resize(a.offsets[N]);
+  a.edgeValues.resize(a.offsets[N]);
+  fillValueOmpU(a.degrees, K());
+  #pragma omp parallel for schedule(dynamic, 2048)
+  for (size_t u=0; u<N; ++u)
+    x.forEachEdge(K(u), [&](auto v, auto w) { csrAddEdgeOmpU(a.degrees, a.edgeKeys, a.edgeValues, a.offsets, v, K(u), w); });
+  csrSortEdgesOmpU(a.degrees, a.edgeKeys, a.edgeValues, a.offsets);
+}
+#endif
+
+
+/**
+ * Replace the vertices and edges of a graph with those of a CSR graph.
+ * @param a output graph (updated)
+ * @param x CSR graph
+ * @param xt transpose of CSR graph (for incoming edges, unused if graph does not memorize them)
+ * @param base vertex id of the first vertex (e.g., 1 for 1-based vertex ids)
+ */
+template <class G, class K, class V, class E, class O>
+inline void csrAssignGraphW(G& a, const DiGraphCsr<K, V, E, O>& x, const DiGraphCsr<K, V, E, O>& xt, size_t base) {
+  using GK = typename G::key_type;
+  using GE = typename G::edge_value_type;
+  size_t N = x.order();
+  vector<pair<GK, GE>> edges;
+  a.clear();
+  a.respan(N + base);
+  for (size_t u=0; u<N; ++u)
+    a.addVertex(GK(u + base));
+  for (size_t u=0; u<N; ++u) {
+    edges.clear();
+    x.forEachEdge(K(u), [&](auto v, auto w) { edges.push_back({GK(v + base), GE(w)}); });
+    a.assignEdges(GK(u + base), edges.begin(), edges.end());
+    if (!a.hasInEdges()) continue;
+    edges.clear();
+    xt.forEachEdge(K(u), [&](auto v, auto w) { edges.push_back({GK(v + base), GE(w)}); });
+    a.assignInEdges(GK(u + base), edges.begin(), edges.end());
+  }
+  a.update();
+}
+
+
+#ifdef OPENMP
+/**
+ * Replace the vertices and edges of a graph with those of a CSR graph, in parallel.
+ * @param a output graph (updated)
+ * @param x CSR graph
+ * @param xt transpose of CSR graph (for incoming edges, unused if graph does not memorize them)
+ * @param base vertex id of the first vertex (e.g., 1 for 1-based vertex ids)
+ */
+template <class G, class K, class V, class E, class O>
+inline void csrAssignGraphOmpW(G& a, const DiGraphCsr<K, V, E, O>& x, const DiGraphCsr<K, V, E, O>& xt, size_t base) {
+  using GK = typename G::key_type;
+  using GE = typename G::edge_value_type;
+  size_t N = x.order();
+  a.clear();
+  a.respan(N + base);
+  for (size_t u=0; u<N; ++u)
+    a.addVertex(GK(u + base));
+  #pragma omp parallel
+  {
+    vector<pair<GK, GE>> edges;
+    #pragma omp for schedule(dynamic, 2048)
+    for (size_t u=0; u<N; ++u) {
+      edges.clear();
+      x.forEachEdge(K(u), [&](auto v, auto w) { edges.push_back({GK(v + base), GE(w)}); });
+      a.assignEdges(GK(u + base), edges.begin(), edges.end());
+      if (!a.hasInEdges()) continue;
+      edges.clear();
+      xt.forEachEdge(K(u), [&](auto v, auto w) { edges.push_back({GK(v + base), GE(w)}); });
+      a.assignInEdges(GK(u + base), edges.begin(), edges.end());
+    }
+  }
+  a.update();
+}
+#endif
 #pragma endregion
@@ -0,0 +1,624 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <ostream>
+#include <stdexcept>
+#include "_main.hxx"
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+using std::tuple;
+using std::get;
+using std::string;
+using std::string_view;
+using std::vector;
+using std::ostream;
+using std::is_sorted;
+using std::min;
+using std::to_string;
+using std::is_same_v;
+using std::is_integral_v;
+using std::runtime_error;
+
+
+
+
+#pragma region CLASSES
+/**
+ * Header of a binary batch update.
+ * @details The header is followed by these sections, each padded to 8 bytes:
+ * sources and targets of edge deletions (deletions x K each), and sources,
+ * targets, and weights of edge insertions (insertions x K each, and
+ * insertions x V, if weighted). All values are stored in native byte order,
+ * so that a mapped file can be iterated upon without any parsing.
+ */
+struct BatchHeader {
+  /** Magic bytes, to identify a batch update. */
+  char magic[8];
+  /** Version of the batch format. */
+  uint32_t version;
+  /** Size of a vertex id, in bytes. */
+  uint16_t keyBytes;
+  /** Size of an edge weight, in bytes (0 if unweighted). */
+  uint16_t edgeBytes;
+  /** Flags, such as BATCH_SORTED. */
+  uint32_t flags;
+  /** Reserved, zero. */
+  uint32_t reserved;
+  /** Number of edge deletions. */
+  uint64_t deletions;
+  /** Number of edge insertions. */
+  uint64_t insertions;
+};
+
+/** Magic bytes of a batch update. */
+#define BATCH_MAGIC "GRAPHBAT"
+/** Version of the batch format. */
+#define BATCH_VERSION 1
+/** Flag: deletions and insertions are each sorted by (u, v). */
+#define BATCH_SORTED 1
+
+
+
+
+/**
+ * Header of a sequence of compressed batch updates.
+ * @details The header is followed by the encoded batches, and then by the
+ * batch index: (batches+1) x uint64 byte offsets of each batch (and of the
+ * end of the last), padded to 8 bytes. Each batch holds the number of edge
+ * deletions and insertions, followed by the deletions (u, v) and insertions
+ * (u, v, w). Edges are split into blocks; in a block, the source of each edge
+ * is stored as a (zigzag) gap from the previous source, and the target as a
+ * gap from the previous target if the source is the same, or else as is.
+ * Integer weights are stored as zigzag values, and others as raw bytes. All
+ * values are stored as variable-length integers (LEB128).
+ */
+struct SequenceHeader {
+  /** Magic bytes, to identify a sequence. */
+  char magic[8];
+  /** Version of the sequence format. */
+  uint32_t version;
+  /** Size of a vertex id, in bytes. */
+  uint16_t keyBytes;
+  /** Size of an edge weight, in bytes (0 if unweighted). */
+  uint16_t edgeBytes;
+  /** Number of edges in a block, after which gaps begin afresh. */
+  uint32_t block;
+  /** Reserved, zero. */
+  uint32_t reserved;
+  /** Number of batches. */
+  uint64_t batches;
+  /** Byte offset of the batch index. */
+  uint64_t index;
+};
+
+/** Magic bytes of a sequence. */
+#define SEQUENCE_MAGIC "GRAPHSEQ"
+/** Version of the sequence format. */
+#define SEQUENCE_VERSION 1
+#ifndef SEQUENCE_BLOCK
+/** Default number of edges in a block of a sequence. */
+#define SEQUENCE_BLOCK 4096
+#endif
+#pragma endregion
+
+
+
+
+#pragma region METHODS
+#pragma region BATCH HEADER
+/**
+ * Get the size of a batch section, padded to 8 bytes.
+ * @param bytes size of section, in bytes
+ * @returns padded size
+ */
+inline size_t batchPadded(size_t bytes) {
+  return (bytes + 7) & ~size_t(7);
+}
+
+
+/**
+ * Get the expected size of a binary batch update.
+ * @param h batch header
+ * @returns size in bytes
+ */
+inline size_t batchBytes(const BatchHeader& h) {
+  size_t D = h.deletions, I = h.insertions;
+  return sizeof(BatchHeader)
+    + 2 * batchPadded(D * h.keyBytes)
+    + 2 * batchPadded(I * h.keyBytes)
+    + batchPadded(I * h.edgeBytes);
+}
+
+
+/**
+ * Read the header of a binary batch update, and check if it matches the edge types.
+ * @tparam K vertex id type
+ * @tparam V edge weight type
+ * @param data batch contents
+ * @param h batch header (updated)
+ * @returns is the batch update valid?
+ */
+template <class K, class V>
+inline bool readBatchHeader(string_view data, BatchHeader& h) {
+  constexpr size_t EDGE_BYTES = is_same_v<V, None>? 0 : sizeof(V);
+  if (data.size() < sizeof(BatchHeader)) return false;
+  memcpy(&h, data.data(), sizeof(BatchHeader));
+  if (memcmp(h.magic, BATCH_MAGIC, sizeof(h.magic))!=0) return false;
+  if (h.version!=BATCH_VERSION) return false;
+  if (h.keyBytes!=sizeof(K) || h.edgeBytes!=EDGE_BYTES) return false;
+  return data.size()>=batchBytes(h);
+}
+#pragma endregion
+
+
+
+
+#pragma region WRITE BATCH
+/**
+ * Write a section of a binary batch update, padded to 8 bytes.
+ * @param a output stream (updated)
+ * @param data section data
+ * @param bytes size of section, in bytes
+ */
+inline void writeBatchSection(ostream& a, const void *data, size_t bytes) {
+  const char zeros[8] = {};
+  a.write((const char*) data, bytes);
+  a.write(zeros, batchPadded(bytes) - bytes);
+}
+
+
+/**
+ * Write a batch update in binary.
+ * @param a output stream (binary, updated)
+ * @param deletions edge deletions in batch update
+ * @param insertions edge insertions in batch update
+ * @note Edges are written in the given order; BATCH_SORTED is set if both
+ * deletions and insertions are sorted by (u, v), as after tidyBatchUpdateU().
+ */
+template <class K, class V>
+inline void writeBatchBinary(ostream& a, const vector<tuple<K, K, V>>& deletions, const vector<tuple<K, K, V>>& insertions) {
+  constexpr bool   WEIGHTED   = !is_same_v<V, None>;
+  constexpr size_t EDGE_BYTES = WEIGHTED? sizeof(V) : 0;
+  size_t D = deletions.size(), I = insertions.size();
+  auto byId = [](const auto& x, const auto& y) { return get<0>(x)<get<0>(y) || (get<0>(x)==get<0>(y) && get<1>(x)<get<1>(y)); };
+  bool sorted = is_sorted(deletions.begin(), deletions.end(), byId) && is_sorted(insertions.begin(), insertions.end(), byId);
+  // Split edges into arrays of sources, targets, and weights.
+  vector<K> du(D), dv(D), iu(I), iv(I);
+  vector<V> iw(WEIGHTED? I : 0);
+  for (size_t i=0; i<D; ++i) {
+    du[i] = get<0>(deletions[i]);
+    dv[i] = get<1>(deletions[i]);
+  }
+  for (size_t i=0; i<I; ++i) {
+    iu[i] = get<0>(insertions[i]);
+    iv[i] = get<1>(insertions[i]);
+    if (WEIGHTED) iw[i] = get<2>(insertions[i]);
+  }
+  // Write header, and then all sections.
+  BatchHeader h = {};
+  memcpy(h.magic, BATCH_MAGIC, sizeof(h.magic));
+  h.version    = BATCH_VERSION;
+  h.keyBytes   = sizeof(K);
+  h.edgeBytes  = EDGE_BYTES;
+  h.flags      = sorted? BATCH_SORTED : 0;
+  h.deletions  = D;
+  h.insertions = I;
+  a.write((const char*) &h, sizeof(h));
+  writeBatchSection(a, du.data(), D * sizeof(K));
+  writeBatchSection(a, dv.data(), D * sizeof(K));
+  writeBatchSection(a, iu.data(), I * sizeof(K));
+  writeBatchSection(a, iv.data(), I * sizeof(K));
+  writeBatchSection(a, iw.data(), I * EDGE_BYTES);
+}
+#pragma endregion
+
+
+
+
+#pragma region READ BATCH
+/**
+ * Iterate over the edges of a binary batch update, in place.
+ * @tparam K vertex id type
+ * @tparam V edge weight type
+ * @param data batch contents (e.g., a mapped file)
+ * @param fd on edge deletion (u, v)
+ * @param fi on edge insertion (u, v, w)
+ * @returns is the batch update valid? (else nothing is notified)
+ * @note Sections are 8-byte aligned, so values are read directly from data.
+ */
+template <class K, class V, class FD, class FI>
+inline bool readBatchBinaryDo(string_view data, FD fd, FI fi) {
+  constexpr bool WEIGHTED = !is_same_v<V, None>;
+  BatchHeader h;
+  if (!readBatchHeader<K, V>(data, h)) return false;
+  size_t D = h.deletions, I = h.insertions;
+  const char *ptr = data.data() + sizeof(BatchHeader);
+  const K *du = (const K*) ptr; ptr += batchPadded(D * sizeof(K));
+  const K *dv = (const K*) ptr; ptr += batchPadded(D * sizeof(K));
+  const K *iu = (const K*) ptr; ptr += batchPadded(I * sizeof(K));
+  const K *iv = (const K*) ptr; ptr += batchPadded(I * sizeof(K));
+  const V *iw = (const V*) ptr;
+  for (size_t i=0; i<D; ++i)
+    fd(du[i], dv[i]);
+  for (size_t i=0; i<I; ++i)
+    fi(iu[i], iv[i], WEIGHTED? iw[i] : V());
+  return true;
+}
+
+
+/**
+ * Read a binary batch update, by mapping it to memory.
+ * @param deletions edge deletions in batch update (output)
+ * @param insertions edge insertions in batch update (output)
+ * @param pth path to batch file
+ * @throws runtime_error if the file is not a valid batch update, with these edge types
+ * @note Deleted edges are read with default weight.
+ */
+template <class K, class V>
+inline void readBatchBinaryW(vector<tuple<K, K, V>>& deletions, vector<tuple<K, K, V>>& insertions, const char *pth) {
+  MappedFile file(pth);
+  file.adviseSequential();
+  BatchHeader h;
+  if (!readBatchHeader<K, V>(file.view(), h)) throw runtime_error(string("Invalid batch file: ") + pth);
+  deletions.clear();
+  insertions.clear();
+  deletions.reserve(h.deletions);
+  insertions.reserve(h.insertions);
+  auto fd = [&](auto u, auto v)         { deletions.push_back({u, v, V()}); };
+  auto fi = [&](auto u, auto v, auto w) { insertions.push_back({u, v, w}); };
+  readBatchBinaryDo<K, V>(file.view(), fd, fi);
+}
+#pragma endregion
+
+
+
+
+#pragma region VARINT
+/**
+ * Map a signed integer to an unsigned one, with small magnitudes to small values.
+ * @param x signed integer
+ * @returns zigzag value
+ */
+inline uint64_t zigzagEncode(int64_t x) {
+  return (uint64_t(x) << 1) ^ uint64_t(x >> 63);
+}
+
+
+/**
+ * Map a zigzag value back to a signed integer.
+ * @param x zigzag value
+ * @returns signed integer
+ */
+inline int64_t zigzagDecode(uint64_t x) {
+  return int64_t(x >> 1) ^ -int64_t(x & 1);
+}
+
+
+/**
+ * Write an unsigned integer as a variable-length integer (LEB128).
+ * @param it output position (at least 10 bytes writable)
+ * @param x unsigned integer
+ * @returns position after the bytes written
+ */
+inline uint8_t* writeVarint(uint8_t *it, uint64_t x) {
+  while (x >= 0x80) {
+    *(it++) = uint8_t(x) | 0x80;
+    x >>= 7;
+  }
+  *(it++) = uint8_t(x);
+  return it;
+}
+
+
+/**
+ * Read a variable-length integer (LEB128).
+ * @param a unsigned integer (updated)
+ * @param ib begin of bytes
+ * @param ie end of bytes
+ * @returns position after the bytes read
+ * @note A single-byte value, the common case for gaps, takes the fast path.
+ */
+inline const uint8_t* readVarintW(uint64_t& a, const uint8_t *ib, const uint8_t *ie) {
+  if (ib<ie && *ib<0x80) { a = *ib; return ib+1; }
+  uint64_t x = 0;
+  for (int s=0; ib<ie && s<64; s+=7) {
+    uint8_t c = *(ib++);
+    x |= uint64_t(c & 0x7F) << s;
+    if (c<0x80) break;
+  }
+  a = x;
+  return ib;
+}
+#pragma endregion
+
+
+
+
+#pragma region ENCODE SEQUENCE
+/**
+ * Get the maximum size of an encoded edge in a sequence.
+ * @tparam V edge weight type
+ * @returns size in bytes
+ */
+template <class V>
+constexpr size_t sequenceEdgeBytes() {
+  return 20 + (sizeof(V) > 10? sizeof(V) : 10);
+}
+
+
+/**
+ * Encode a block of edges of a batch update.
+ * @tparam WEIGHTED encode edge weights?
+ * @param it output position (sequenceEdgeBytes() x edges writable)
+ * @param ib begin of edges
+ * @param ie end of edges
+ * @returns position after the bytes written
+ */
+template <bool WEIGHTED, class K, class V>
+inline uint8_t* encodeSequenceEdges(uint8_t *it, const tuple<K, K, V> *ib, const tuple<K, K, V> *ie) {
+  int64_t pu = 0, pv = 0;
+  for (; ib<ie; ++ib) {
+    const auto& [u, v, w] = *ib;
+    it = writeVarint(it, zigzagEncode(int64_t(u) - pu));
+    it = writeVarint(it, int64_t(u)==pu? zigzagEncode(int64_t(v) - pv) : uint64_t(v));
+    pu = int64_t(u); pv = int64_t(v);
+    if constexpr (!WEIGHTED || is_same_v<V, None>) continue;
+    else if constexpr (is_integral_v<V>) it = writeVarint(it, zigzagEncode(int64_t(w)));
+    else { memcpy(it, &w, sizeof(V)); it += sizeof(V); }
+  }
+  return it;
+}
+
+
+/**
+ * Decode a block of edges of a batch update.
+ * @tparam WEIGHTED decode edge weights?
+ * @param ib begin of bytes
+ * @param ie end of bytes
+ * @param n number of edges in block
+ * @param fe on edge (u, v, w)
+ * @returns position after the bytes read
+ */
+template <bool WEIGHTED, class K, class V, class FE>
+inline const uint8_t* decodeSequenceEdges(const uint8_t *ib, const uint8_t *ie, size_t n, FE fe) {
+  int64_t pu = 0, pv = 0;
+  for (size_t i=0; i<n; ++i) {
+    uint64_t du = 0, dv = 0; V w = V();
+    ib = readVarintW(du, ib, ie);
+    ib = readVarintW(dv, ib, ie);
+    int64_t u = pu + zigzagDecode(du);
+    int64_t v = u==pu? pv + zigzagDecode(dv) : int64_t(dv);
+    pu = u; pv = v;
+    if constexpr (!WEIGHTED || is_same_v<V, None>) {}
+    else if constexpr (is_integral_v<V>) { uint64_t x = 0; ib = readVarintW(x, ib, ie); w = V(zigzagDecode(x)); }
+    else { if (ie-ib >= ptrdiff_t(sizeof(V))) memcpy(&w, ib, sizeof(V)); ib += sizeof(V); }
+    fe(K(u), K(v), w);
+  }
+  return ib;
+}
+
+
+/**
+ * Encode the c-th block of edges of a batch update.
+ * @param it output position (sequenceEdgeBytes() x block writable)
+ * @param deletions edge deletions in batch update
+ * @param insertions edge insertions in batch update
+ * @param block number of edges in a block
+ * @param c block index (deletion blocks first, then insertion blocks)
+ * @returns position after the bytes written
+ */
+template <class K, class V>
+inline uint8_t* encodeSequenceBlock(uint8_t *it, const vector<tuple<K, K, V>>& deletions, const vector<tuple<K, K, V>>& insertions, size_t block, size_t c) {
+  size_t D = deletions.size(), I = insertions.size();
+  size_t BD = (D + block - 1) / block;
+  if (c<BD) {
+    size_t i = c*block, I0 = min(i+block, D);
+    return encodeSequenceEdges<false>(it, deletions.data() + i, deletions.data() + I0);
+  }
+  size_t i = (c-BD)*block, I1 = min(i+block, I);
+  return encodeSequenceEdges<true>(it, insertions.data() + i, insertions.data() + I1);
+}
+#pragma endregion
+
+
+
+
+#pragma region WRITE SEQUENCE
+/**
+ * Write the header of a sequence of compressed batch updates.
+ * @tparam K vertex id type
+ * @tparam V edge weight type
+ * @param a output stream (binary, updated)
+ * @param offsets byte offsets of each batch, and of the end (output)
+ * @param block number of edges in a block
+ * @note The header is written again, with the batch count and index, by writeSequenceIndex().
+ */
+template <class K, class V>
+inline void writeSequenceHeader(ostream& a, vector<uint64_t>& offsets, size_t block=SEQUENCE_BLOCK) {
+  SequenceHeader h = {};
+  memcpy(h.magic, SEQUENCE_MAGIC, sizeof(h.magic));
+  h.version   = SEQUENCE_VERSION;
+  h.keyBytes  = sizeof(K);
+  h.edgeBytes = is_same_v<V, None>? 0 : sizeof(V);
+  h.block     = uint32_t(block);
+  a.write((const char*) &h, sizeof(h));
+  offsets.assign(1, sizeof(h));
+}
+
+
+/**
+ * Append a batch update to a sequence.
+ * @param a output stream (binary, updated)
+ * @param offsets byte offsets of each batch, and of the end (updated)
+ * @param deletions edge deletions in batch update
+ * @param insertions edge insertions in batch update
+ * @param block number of edges in a block
+ */
+template <class K, class V>
+inline void writeSequenceBatch(ostream& a, vector<uint64_t>& offsets, const vector<tuple<K, K, V>>& deletions, const vector<tuple<K, K, V>>& insertions, size_t block=SEQUENCE_BLOCK) {
+  size_t D = deletions.size(), I = insertions.size();
+  size_t B = (D + block - 1) / block + (I + block - 1) / block;
+  vector<uint8_t> buf(block * sequenceEdgeBytes<V>());
+  uint8_t head[20];
+  size_t bytes = writeVarint(writeVarint(head, D), I) - head;
+  a.write((const char*) head, bytes);
+  for (size_t c=0; c<B; ++c) {
+    size_t n = encodeSequenceBlock(buf.data(), deletions, insertions, block, c) - buf.data();
+    a.write((const char*) buf.data(), n);
+    bytes += n;
+  }
+  offsets.push_back(offsets.back() + bytes);
+}
+
+
+#ifdef OPENMP
+/**
+ * Append a batch update to a sequence, encoding its blocks in parallel.
+ * @param a output stream (binary, updated)
+ * @param offsets byte offsets of each batch, and of the end (updated)
+ * @param deletions edge deletions in batch update
+ * @param insertions edge insertions in batch update
+ * @param block number of edges in a block
+ * @note In each round, threads encode a block each into their own buffer,
+ * which are then written in order.
+ */
+template <class K, class V>
+inline void writeSequenceBatchOmp(ostream& a, vector<uint64_t>& offsets, const vector<tuple<K, K, V>>& deletions, const vector<tuple<K, K, V>>& insertions, size_t block=SEQUENCE_BLOCK) {
+  const int T = omp_get_max_threads();
+  size_t D = deletions.size(), I = insertions.size();
+  size_t B = (D + block - 1) / block + (I + block - 1) / block;
+  vector<vector<uint8_t>> bufs(T);
+  vector<size_t> sizes(T);
+  uint8_t head[20];
+  size_t bytes = writeVarint(writeVarint(head, D), I) - head;
+  a.write((const char*) head, bytes);
+  for (size_t r=0; r<B; r+=T) {
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int t=0; t<T; ++t) {
+      size_t c = r + t;
+      if (c>=B) { sizes[t] = 0; continue; }
+      bufs[t].resize(block * sequenceEdgeBytes<V>());
+      sizes[t] = encodeSequenceBlock(bufs[t].data(), deletions, insertions, block, c) - bufs[t].data();
+    }
+    for (int t=0; t<T; ++t) {
+      a.write((const char*) bufs[t].data(), sizes[t]);
+      bytes += sizes[t];
+    }
+  }
+  offsets.push_back(offsets.back() + bytes);
+}
+#endif
+
+
+/**
+ * Finish a sequence, by writing the batch index and updating the header.
+ * @tparam K vertex id type
+ * @tparam V edge weight type
+ * @param a output stream (binary, seekable, updated)
+ * @param offsets byte offsets of each batch, and of the end
+ * @param block number of edges in a block
+ */
+template <class K, class V>
+inline void writeSequenceIndex(ostream& a, const vector<uint64_t>& offsets, size_t block=SEQUENCE_BLOCK) {
+  const char zeros[8] = {};
+  uint64_t end   = offsets.back();
+  uint64_t index = batchPadded(end);
+  a.write(zeros, index - end);
+  a.write((const char*) offsets.data(), offsets.size() * sizeof(uint64_t));
+  SequenceHeader h = {};
+  memcpy(h.magic, SEQUENCE_MAGIC, sizeof(h.magic));
+  h.version   = SEQUENCE_VERSION;
+  h.keyBytes  = sizeof(K);
+  h.edgeBytes = is_same_v<V, None>? 0 : sizeof(V);
+  h.block     = uint32_t(block);
+  h.batches   = offsets.size() - 1;
+  h.index     = index;
+  a.seekp(0);
+  a.write((const char*) &h, sizeof(h));
+  a.seekp(0, std::ios::end);
+}
+#pragma endregion
+
+
+
+
+#pragma region READ SEQUENCE
+/**
+ * Read the header of a sequence of compressed batch updates, and check if it matches the edge types.
+ * @tparam K vertex id type
+ * @tparam V edge weight type
+ * @param data sequence contents
+ * @param h sequence header (updated)
+ * @returns is the sequence valid and finished?
+ */
+template <class K, class V>
+inline bool readSequenceHeader(string_view data, SequenceHeader& h) {
+  constexpr size_t EDGE_BYTES = is_same_v<V, None>? 0 : sizeof(V);
+  if (data.size() < sizeof(SequenceHeader)) return false;
+  memcpy(&h, data.data(), sizeof(SequenceHeader));
+  if (memcmp(h.magic, SEQUENCE_MAGIC, sizeof(h.magic))!=0) return false;
+  if (h.version!=SEQUENCE_VERSION || h.block==0) return false;
+  if (h.keyBytes!=sizeof(K) || h.edgeBytes!=EDGE_BYTES) return false;
+  if (h.index % 8!=0 || h.index > data.size()) return false;
+  return data.size() - h.index == (h.batches+1) * sizeof(uint64_t);
+}
+
+
+/**
+ * Iterate over the edges of a batch update in a sequence.
+ * @tparam K vertex id type
+ * @tparam V edge weight type
+ * @param data sequence contents (e.g., a mapped file)
+ * @param k batch index
+ * @param fd on edge deletion (u, v)
+ * @param fi on edge insertion (u, v, w)
+ * @returns is the sequence valid, and does it have batch k? (else nothing is notified)
+ * @note The batch is found with the batch index, and decoded independently of others.
+ */
+template <class K, class V, class FD, class FI>
+inline bool readSequenceBatchDo(string_view data, size_t k, FD fd, FI fi) {
+  SequenceHeader h;
+  if (!readSequenceHeader<K, V>(data, h) || k>=h.batches) return false;
+  const uint64_t *offsets = (const uint64_t*) (data.data() + h.index);
+  if (offsets[k] > offsets[k+1] || offsets[k+1] > h.index) return false;
+  const uint8_t *ib = (const uint8_t*) data.data() + offsets[k];
+  const uint8_t *ie = (const uint8_t*) data.data() + offsets[k+1];
+  uint64_t D = 0, I = 0;
+  ib = readVarintW(D, ib, ie);
+  ib = readVarintW(I, ib, ie);
+  auto fe = [&](auto u, auto v, auto w) { fd(u, v); };
+  for (uint64_t i=0; i<D; i+=h.block)
+    ib = decodeSequenceEdges<false, K, V>(ib, ie, min(uint64_t(h.block), D-i), fe);
+  for (uint64_t i=0; i<I; i+=h.block)
+    ib = decodeSequenceEdges<true,  K, V>(ib, ie, min(uint64_t(h.block), I-i), fi);
+  return true;
+}
+
+
+/**
+ * Read a batch update from a sequence.
+ * @param deletions edge deletions in batch update (output)
+ * @param insertions edge insertions in batch update (output)
+ * @param data sequence contents (e.g., a mapped file)
+ * @param k batch index
+ * @throws runtime_error if the sequence is not valid, or does not have batch k
+ * @note Deleted edges are read with default weight.
+ */
+template <class K, class V>
+inline void readSequenceBatchW(vector<tuple<K, K, V>>& deletions, vector<tuple<K, K, V>>& insertions, string_view data, size_t k) {
+  deletions.clear();
+  insertions.clear();
+  auto fd = [&](auto u, auto v)         { deletions.push_back({u, v, V()}); };
+  auto fi = [&](auto u, auto v, auto w) { insertions.push_back({u, v, w}); };
+  if (!readSequenceBatchDo<K, V>(data, k, fd, fi)) throw runtime_error("Invalid sequence, or missing batch: " + to_string(k));
+}
+#pragma endregion
+#pragma endregion
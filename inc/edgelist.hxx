@@ -0,0 +1,1032 @@
+#pragma once
+#include <utility>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <charconv>
+#include <ostream>
+#include <future>
+#include "_main.hxx"
+#include "Graph.hxx"
+#include "update.hxx"
+#include "csr.hxx"
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+using std::tuple;
+using std::get;
+using std::string;
+using std::string_view;
+using std::min;
+using std::max;
+using std::ostream;
+using std::future;
+using std::async;
+using std::launch;
+using std::to_chars;
+
+
+
+
+#pragma region METHODS
+#pragma region READ EDGELIST LINE
+/**
+ * Read a line (u, v, [w]) of an edgelist.
+ * @param u source vertex (updated)
+ * @param v target vertex (updated)
+ * @param w edge weight, unchanged if absent (updated)
+ * @param ib begin of line
+ * @param ie end of line (or text)
+ * @param weighted is it weighted?
+ * @returns position after the last number read, or ib if no edge was read
+ */
+inline const char* readEdgelistLineW(size_t& u, size_t& v, double& w, const char *ib, const char *ie, bool weighted) {
+  const char *iu = findNextNonBlank(ib, ie);
+  const char *ju = readUintW(u, iu, ie);
+  if (ju==iu) return ib;
+  const char *iv = findNextNonBlank(ju, ie);
+  const char *jv = readUintW(v, iv, ie);
+  if (jv==iv) return ib;
+  if (!weighted) return jv;
+  const char *iw = findNextNonBlank(jv, ie);
+  double x = 0;
+  const char *jw = readFloatW(x, iw, ie);
+  if (jw==iw) return jv;
+  w = x;
+  return jw;
+}
+
+
+/**
+ * Read a line (u, v, [w]) of an edgelist.
+ * @param u source vertex (updated)
+ * @param v target vertex (updated)
+ * @param w edge weight, unchanged if absent (updated)
+ * @param line input line
+ * @param weighted is it weighted?
+ * @returns was an edge read?
+ */
+inline bool readEdgelistLineW(size_t& u, size_t& v, double& w, const string& line, bool weighted) {
+  const char *ib = line.data(), *ie = ib + line.size();
+  return readEdgelistLineW(u, v, w, ib, ie, weighted)!=ib;
+}
+#pragma endregion
+
+
+
+
+#pragma region READ EDGELIST BODY
+/**
+ * Read body lines (u, v, [w]) of an edgelist in a range of text.
+ * @param ib begin of text (at a line)
+ * @param ie end of text
+ * @param weighted is it weighted?
+ * @param fb on body line (u, v, w)
+ * @note Lines that do not begin with two numbers (comments) are skipped.
+ */
+template <class FB>
+inline void readEdgelistBodyDo(const char *ib, const char *ie, bool weighted, FB fb) {
+  for (const char *it=ib; it<ie;) {
+    size_t u = 0, v = 0; double w = 0;
+    const char *jt = readEdgelistLineW(u, v, w, it, ie, weighted);
+    bool read = jt!=it;
+    it = findNextLine(jt, ie);  // Continue after the numbers read.
+    if (read) fb(u, v, w? w : 1);
+  }
+}
+
+
+#ifdef OPENMP
+/**
+ * Read body lines (u, v, [w]) of an edgelist in a range of text.
+ * @param ib begin of text (at a line)
+ * @param ie end of text
+ * @param weighted is it weighted?
+ * @param symmetric is it symmetric?
+ * @param fb on body line (u, v, w)
+ * @note The text is processed in blocks, each split into line-aligned byte
+ * ranges, one per thread, which are parsed in place (no line copies). Each
+ * edge is notified only on the threads that own its source or target vertex
+ * (see belongsOmp).
+ */
+template <class FB>
+inline void readEdgelistBodyDoOmp(const char *ib, const char *ie, bool weighted, bool symmetric, FB fb) {
+  // Process body in blocks, to bound the memory used for parsed edges.
+  const int    THREADS = omp_get_max_threads();
+  const size_t BLOCK   = size_t(THREADS) << 24;
+  vector<vector2d<tuple<size_t, size_t, double>>> edges(THREADS, vector2d<tuple<size_t, size_t, double>>(THREADS));
+  for (const char *bb=ib; bb<ie;) {
+    const char *be = alignToLine(bb, ie, bb + min(BLOCK, size_t(ie-bb)));
+    #pragma omp parallel
+    {
+      // Parse line-aligned byte ranges using multiple threads, and bucket them by owner thread.
+      clearBucketedEdgesOmpU(edges);
+      int T = omp_get_num_threads();
+      int t = omp_get_thread_num();
+      size_t B = be - bb;
+      const char *rb = alignToLine(bb, be, bb + B*t/T);
+      const char *re = alignToLine(bb, be, bb + B*(t+1)/T);
+      readEdgelistBodyDo(rb, re, weighted, [&](auto u, auto v, auto w) { bucketEdgeOmpU(edges[t], u, v, w); });
+      #pragma omp barrier
+      // Notify parsed lines, to their owner threads only.
+      forEachBucketedEdgeOmp(edges, [&](auto u, auto v, auto w) {
+        fb(u, v, w);
+        if (symmetric) fb(v, u, w);
+      });
+    }
+    bb = be;
+  }
+}
+#endif
+#pragma endregion
+
+
+
+
+#pragma region READ EDGELIST BODY CSR
+/**
+ * Read body lines (u, v, [w]) of an edgelist in a range of text, into a CSR graph.
+ * @param a output graph (updated, with span set)
+ * @param ib begin of text (at a line)
+ * @param ie end of text
+ * @param weighted is it weighted?
+ * @param symmetric is it symmetric?
+ * @param base offset to add to vertex ids
+ * @note The text is parsed twice: once to count the degree of each vertex, and
+ * once to scatter edges into place. The edges of each vertex are then sorted,
+ * and duplicates removed. Edges with a vertex id beyond the span are skipped.
+ */
+template <class G>
+inline void readEdgelistBodyCsrW(G& a, const char *ib, const char *ie, bool weighted, bool symmetric, size_t base) {
+  using K = typename G::key_type;
+  using E = typename G::edge_value_type;
+  size_t N = a.span();
+  // Count the degree of each vertex.
+  fillValueU(a.degrees, K());
+  readEdgelistBodyDo(ib, ie, false, [&](auto u, auto v, auto w) {
+    if (u+base >= N || v+base >= N) return;
+    ++a.degrees[u+base];
+    if (symmetric) ++a.degrees[v+base];
+  });
+  // Obtain offsets, and allocate space for edges.
+  size_t M = exclusiveScanW(a.offsets.data(), a.degrees.data(), N);
+  a.offsets[N] = M;
+  a.edgeKeys.resize(M);
+  a.edgeValues.resize(M);
+  // Scatter edges into place.
+  fillValueU(a.degrees, K());
+  readEdgelistBodyDo(ib, ie, weighted, [&](auto u, auto v, auto w) {
+    if (u+base >= N || v+base >= N) return;
+    csrAddEdgeU(a.degrees, a.edgeKeys, a.edgeValues, a.offsets, K(u+base), K(v+base), E(w));
+    if (symmetric) csrAddEdgeU(a.degrees, a.edgeKeys, a.edgeValues, a.offsets, K(v+base), K(u+base), E(w));
+  });
+  csrSortEdgesU(a.degrees, a.edgeKeys, a.edgeValues, a.offsets);
+}
+
+
+#ifdef OPENMP
+/**
+ * Read body lines (u, v, [w]) of an edgelist in a range of text, into a CSR graph.
+ * @param a output graph (updated, with span set)
+ * @param ib begin of text (at a line)
+ * @param ie end of text
+ * @param weighted is it weighted?
+ * @param symmetric is it symmetric?
+ * @param base offset to add to vertex ids
+ * @note The text is parsed twice, in line-aligned byte ranges, one per thread:
+ * once to count the degree of each vertex, and once to scatter edges into
+ * place. The edges of each vertex are then sorted, and duplicates removed.
+ * Edges with a vertex id beyond the span are skipped.
+ */
+template <class G>
+inline void readEdgelistBodyCsrOmpW(G& a, const char *ib, const char *ie, bool weighted, bool symmetric, size_t base) {
+  using K = typename G::key_type;
+  using E = typename G::edge_value_type;
+  using O = typename decltype(a.offsets)::value_type;
+  size_t N = a.span();
+  // Count the degree of each vertex.
+  fillValueOmpU(a.degrees, K());
+  #pragma omp parallel
+  {
+    int T = omp_get_num_threads();
+    int t = omp_get_thread_num();
+    size_t B = ie - ib;
+    const char *rb = alignToLine(ib, ie, ib + B*t/T);
+    const char *re = alignToLine(ib, ie, ib + B*(t+1)/T);
+    readEdgelistBodyDo(rb, re, false, [&](auto u, auto v, auto w) {
+      if (u+base >= N || v+base >= N) return;
+      #pragma omp atomic
+      ++a.degrees[u+base];
+      if (!symmetric) return;
+      #pragma omp atomic
+      ++a.degrees[v+base];
+    });
+  }
+  // Obtain offsets, and allocate space for edges.
+  vector<O> buf(omp_get_max_threads());
+  size_t M = exclusiveScanOmpW(a.offsets.data(), buf.data(), a.degrees.data(), N);
+  a.offsets[N] = M;
+  a.edgeKeys.resize(M);
+  a.edgeValues.resize(M);
+  // Scatter edges into place.
+  fillValueOmpU(a.degrees, K());
+  #pragma omp parallel
+  {
+    int T = omp_get_num_threads();
+    int t = omp_get_thread_num();
+    size_t B = ie - ib;
+    const char *rb = alignToLine(ib, ie, ib + B*t/T);
+    const char *re = alignToLine(ib, ie, ib + B*(t+1)/T);
+    readEdgelistBodyDo(rb, re, weighted, [&](auto u, auto v, auto w) {
+      if (u+base >= N || v+base >= N) return;
+      csrAddEdgeOmpU(a.degrees, a.edgeKeys, a.edgeValues, a.offsets, K(u+base), K(v+base), E(w));
+      if (symmetric) csrAddEdgeOmpU(a.degrees, a.edgeKeys, a.edgeValues, a.offsets, K(v+base), K(u+base), E(w));
+    });
+  }
+  csrSortEdgesOmpU(a.degrees, a.edgeKeys, a.edgeValues, a.offsets);
+}
+#endif
+#pragma endregion
+
+
+
+
+#pragma region READ EDGELIST HEADER
+/**
+ * Check if the first edge of an edgelist has a weight.
+ * @param ib begin of text (at a line)
+ * @param ie end of text
+ * @returns does the first line with an edge have a third number?
+ */
+inline bool readEdgelistWeighted(const char *ib, const char *ie) {
+  for (const char *it=ib; it<ie; it=findNextLine(it, ie)) {
+    size_t u = 0, v = 0; double w = 0;
+    const char *jv = readEdgelistLineW(u, v, w, it, ie, false);
+    if (jv==it) continue;
+    const char *iw = findNextNonBlank(jv, ie);
+    return readFloatW(w, iw, ie)!=iw;
+  }
+  return false;
+}
+
+
+/**
+ * Infer the header of an edgelist file, by scanning its contents.
+ * @param data file contents
+ * @param weighted does it have edge weights? (updated)
+ * @param rows number of vertices, after shifting 0-based ids (updated)
+ * @param size number of edges (updated)
+ * @param zeroBased does it use 0-based vertex ids? (updated)
+ * @note Vertex ids are 1-based in a graph, so 0-based ids must be shifted by 1.
+ */
+inline void readEdgelistHeader(string_view data, bool& weighted, size_t& rows, size_t& size, bool& zeroBased) {
+  const char *ib = data.data(), *ie = ib + data.size();
+  size_t lo = size_t(-1), hi = 0, m = 0;
+  readEdgelistBodyDo(ib, ie, false, [&](auto u, auto v, auto w) {
+    lo = min(lo, min(u, v));
+    hi = max(hi, max(u, v));
+    ++m;
+  });
+  weighted  = readEdgelistWeighted(ib, ie);
+  zeroBased = m>0 && lo==0;
+  rows = m>0? hi + (zeroBased? 1 : 0) : 0;
+  size = m;
+}
+
+
+#ifdef OPENMP
+/**
+ * Infer the header of an edgelist file, by scanning its contents in parallel.
+ * @param data file contents
+ * @param weighted does it have edge weights? (updated)
+ * @param rows number of vertices, after shifting 0-based ids (updated)
+ * @param size number of edges (updated)
+ * @param zeroBased does it use 0-based vertex ids? (updated)
+ * @note Vertex ids are 1-based in a graph, so 0-based ids must be shifted by 1.
+ */
+inline void readEdgelistHeaderOmp(string_view data, bool& weighted, size_t& rows, size_t& size, bool& zeroBased) {
+  const char *ib = data.data(), *ie = ib + data.size();
+  size_t lo = size_t(-1), hi = 0, m = 0;
+  #pragma omp parallel reduction(min:lo) reduction(max:hi) reduction(+:m)
+  {
+    int T = omp_get_num_threads();
+    int t = omp_get_thread_num();
+    size_t B = ie - ib;
+    const char *rb = alignToLine(ib, ie, ib + B*t/T);
+    const char *re = alignToLine(ib, ie, ib + B*(t+1)/T);
+    readEdgelistBodyDo(rb, re, false, [&](auto u, auto v, auto w) {
+      lo = min(lo, min(u, v));
+      hi = max(hi, max(u, v));
+      ++m;
+    });
+  }
+  weighted  = readEdgelistWeighted(ib, ie);
+  zeroBased = m>0 && lo==0;
+  rows = m>0? hi + (zeroBased? 1 : 0) : 0;
+  size = m;
+}
+#endif
+#pragma endregion
+
+
+
+
+#pragma region READ EDGELIST DEGREES
+/**
+ * Count the out- and in-degree of each vertex, from body lines of an edgelist.
+ * @param degrees out-degree of each vertex (updated)
+ * @param inDegrees in-degree of each vertex (updated)
+ * @param ib begin of text (at a line)
+ * @param ie end of text
+ * @param symmetric is it symmetric?
+ * @param base offset to add to vertex ids
+ * @note Edges with vertex ids beyond the span of the degree vectors are skipped.
+ */
+template <class K>
+inline void readEdgelistDegreesW(vector<K>& degrees, vector<K>& inDegrees, const char *ib, const char *ie, bool symmetric, size_t base) {
+  size_t N = degrees.size();
+  readEdgelistBodyDo(ib, ie, false, [&](auto u, auto v, auto w) {
+    if (u+base >= N || v+base >= N) return;
+    ++degrees[u+base]; ++inDegrees[v+base];
+    if (!symmetric) return;
+    ++degrees[v+base]; ++inDegrees[u+base];
+  });
+}
+
+
+#ifdef OPENMP
+/**
+ * Count the out- and in-degree of each vertex, from body lines of an edgelist.
+ * @param degrees out-degree of each vertex (updated)
+ * @param inDegrees in-degree of each vertex (updated)
+ * @param ib begin of text (at a line)
+ * @param ie end of text
+ * @param symmetric is it symmetric?
+ * @param base offset to add to vertex ids
+ * @note Edges with vertex ids beyond the span of the degree vectors are skipped.
+ */
+template <class K>
+inline void readEdgelistDegreesOmpW(vector<K>& degrees, vector<K>& inDegrees, const char *ib, const char *ie, bool symmetric, size_t base) {
+  size_t N = degrees.size();
+  #pragma omp parallel
+  {
+    int T = omp_get_num_threads();
+    int t = omp_get_thread_num();
+    size_t B = ie - ib;
+    const char *rb = alignToLine(ib, ie, ib + B*t/T);
+    const char *re = alignToLine(ib, ie, ib + B*(t+1)/T);
+    readEdgelistBodyDo(rb, re, false, [&](auto u, auto v, auto w) {
+      if (u+base >= N || v+base >= N) return;
+      #pragma omp atomic
+      ++degrees[u+base];
+      #pragma omp atomic
+      ++inDegrees[v+base];
+      if (!symmetric) return;
+      #pragma omp atomic
+      ++degrees[v+base];
+      #pragma omp atomic
+      ++inDegrees[u+base];
+    });
+  }
+}
+#endif
+
+
+/**
+ * Count the out- and in-degree of each vertex in an edgelist file, by mapping it to memory.
+ * @param degrees out-degree of each vertex (output)
+ * @param inDegrees in-degree of each vertex (output)
+ * @param pth file path
+ * @note Vertex ids are 1-based, as with other readers.
+ */
+template <class K>
+inline void readEdgelistDegreesW(vector<K>& degrees, vector<K>& inDegrees, const char *pth) {
+  MappedFile file(pth);
+  file.adviseSequential();
+  string_view data = file.view();
+  bool weighted, zeroBased; size_t rows, size;
+  readEdgelistHeader(data, weighted, rows, size, zeroBased);
+  degrees.assign(rows+1, K());
+  inDegrees.assign(rows+1, K());
+  readEdgelistDegreesW(degrees, inDegrees, data.data(), data.data() + data.size(), false, zeroBased? 1 : 0);
+}
+
+
+#ifdef OPENMP
+/**
+ * Count the out- and in-degree of each vertex in an edgelist file in parallel, by mapping it to memory.
+ * @param degrees out-degree of each vertex (output)
+ * @param inDegrees in-degree of each vertex (output)
+ * @param pth file path
+ * @note Vertex ids are 1-based, as with other readers.
+ */
+template <class K>
+inline void readEdgelistDegreesOmpW(vector<K>& degrees, vector<K>& inDegrees, const char *pth) {
+  MappedFile file(pth);
+  file.adviseSequential();
+  string_view data = file.view();
+  bool weighted, zeroBased; size_t rows, size;
+  readEdgelistHeaderOmp(data, weighted, rows, size, zeroBased);
+  degrees.assign(rows+1, K());
+  inDegrees.assign(rows+1, K());
+  readEdgelistDegreesOmpW(degrees, inDegrees, data.data(), data.data() + data.size(), false, zeroBased? 1 : 0);
+}
+#endif
+#pragma endregion
+
+
+
+
+#pragma region READ EDGELIST DO
+/**
+ * Read contents of an edgelist file, by mapping it to memory.
+ * @param pth file path
+ * @param fh on header (weighted, rows, size)
+ * @param fb on body line (u, v, w)
+ */
+template <class FH, class FB>
+inline void readEdgelistDoMmap(const char *pth, FH fh, FB fb) {
+  MappedFile file(pth);
+  file.adviseSequential();
+  string_view data = file.view();
+  bool weighted, zeroBased; size_t rows, size;
+  readEdgelistHeader(data, weighted, rows, size, zeroBased);
+  fh(weighted, rows, size);
+  if (rows==0) return;
+  // Process body lines sequentially.
+  size_t b = zeroBased? 1 : 0;
+  readEdgelistBodyDo(data.data(), data.data() + data.size(), weighted, [&](auto u, auto v, auto w) {
+    fb(u+b, v+b, w);
+  });
+}
+
+
+#ifdef OPENMP
+/**
+ * Read contents of an edgelist file, by mapping it to memory.
+ * @param pth file path
+ * @param fh on header (weighted, rows, size)
+ * @param fb on body line (u, v, w)
+ * @note Each edge is notified only on the threads that own its source or
+ * target vertex (see belongsOmp).
+ */
+template <class FH, class FB>
+inline void readEdgelistDoMmapOmp(const char *pth, FH fh, FB fb) {
+  MappedFile file(pth);
+  file.adviseSequential();
+  string_view data = file.view();
+  bool weighted, zeroBased; size_t rows, size;
+  readEdgelistHeaderOmp(data, weighted, rows, size, zeroBased);
+  fh(weighted, rows, size);
+  if (rows==0) return;
+  // Process body lines in parallel.
+  size_t b = zeroBased? 1 : 0;
+  readEdgelistBodyDoOmp(data.data(), data.data() + data.size(), weighted, false, [&](auto u, auto v, auto w) {
+    fb(u+b, v+b, w);
+  });
+}
+#endif
+#pragma endregion
+
+
+
+
+#pragma region READ EDGELIST IF
+/**
+ * Read edgelist file as graph if test passes, by mapping it to memory.
+ * @param a output graph (updated)
+ * @param pth file path
+ * @param fv include vertex? (u, d)
+ * @param fe include edge? (u, v, w)
+ * @param reserve count degrees first, to reserve exact space for edges?
+ * @note Vertices and edges (exact, or average degree) are reserved before loading.
+ * The file is mapped, and its header inferred, only once for all passes.
+ */
+template <class G, class FV, class FE>
+inline void readEdgelistIfMmapW(G &a, const char *pth, FV fv, FE fe, bool reserve=false) {
+  using K = typename G::key_type;
+  using V = typename G::vertex_value_type;
+  using E = typename G::edge_value_type;
+  MappedFile file(pth);
+  file.adviseSequential();
+  string_view data = file.view();
+  const char *ib = data.data(), *ie = ib + data.size();
+  bool weighted, zeroBased; size_t rows, size;
+  readEdgelistHeader(data, weighted, rows, size, zeroBased);
+  size_t b = zeroBased? 1 : 0;
+  a.reserve(rows+1, reserve || rows==0? 0 : (size + rows - 1) / rows);
+  addVerticesIfU(a, K(1), K(rows+1), V(), fv);
+  if (reserve) {
+    vector<K> degrees(rows+1), inDegrees(rows+1);
+    readEdgelistDegreesW(degrees, inDegrees, ib, ie, false, b);
+    reserveEdgesU(a, degrees, inDegrees);
+  }
+  if (rows>0) readEdgelistBodyDo(ib, ie, weighted, [&](auto u, auto v, auto w) {
+    if (fe(K(u+b), K(v+b), K(w))) a.addEdge(K(u+b), K(v+b), E(w));
+  });
+  a.update();
+}
+
+
+#ifdef OPENMP
+/**
+ * Read edgelist file as graph if test passes, by mapping it to memory.
+ * @param a output graph (updated)
+ * @param pth file path
+ * @param fv include vertex? (u, d)
+ * @param fe include edge? (u, v, w)
+ * @param reserve count degrees first, to reserve exact space for edges?
+ * @note Vertices and edges (exact, or average degree) are reserved before loading.
+ * The file is mapped, and its header inferred, only once for all passes.
+ */
+template <class G, class FV, class FE>
+inline void readEdgelistIfMmapOmpW(G &a, const char *pth, FV fv, FE fe, bool reserve=false) {
+  using K = typename G::key_type;
+  using V = typename G::vertex_value_type;
+  using E = typename G::edge_value_type;
+  MappedFile file(pth);
+  file.adviseSequential();
+  string_view data = file.view();
+  const char *ib = data.data(), *ie = ib + data.size();
+  bool weighted, zeroBased; size_t rows, size;
+  readEdgelistHeaderOmp(data, weighted, rows, size, zeroBased);
+  size_t b = zeroBased? 1 : 0;
+  a.reserve(rows+1);
+  if (reserve) {
+    vector<K> degrees(rows+1), inDegrees(rows+1);
+    readEdgelistDegreesOmpW(degrees, inDegrees, ib, ie, false, b);
+    reserveEdgesOmpU(a, degrees, inDegrees);
+  }
+  else {
+    size_t deg = rows? (size + rows - 1) / rows : 0;
+    #pragma omp parallel for schedule(static, 2048)
+    for (size_t u=1; u<=rows; ++u)
+      a.reserveEdges(K(u), deg);
+  }
+  addVerticesIfU(a, K(1), K(rows+1), V(), fv);
+  if (rows>0) readEdgelistBodyDoOmp(ib, ie, weighted, false, [&](auto u, auto v, auto w) {
+    if (fe(K(u+b), K(v+b), K(w))) addEdgeOmpU(a, K(u+b), K(v+b), E(w));
+  });
+  updateOmpU(a);
+}
+#endif
+#pragma endregion
+
+
+
+
+#pragma region READ EDGELIST
+/**
+ * Read edgelist file as graph, by mapping it to memory.
+ * @param a output graph (updated)
+ * @param pth file path
+ * @param reserve count degrees first, to reserve exact space for edges?
+ */
+template <class G>
+inline void readEdgelistMmapW(G& a, const char *pth, bool reserve=false) {
+  auto fv = [](auto u, auto d)         { return true; };
+  auto fe = [](auto u, auto v, auto w) { return true; };
+  readEdgelistIfMmapW(a, pth, fv, fe, reserve);
+}
+
+
+#ifdef OPENMP
+/**
+ * Read edgelist file as graph, by mapping it to memory.
+ * @param a output graph (updated)
+ * @param pth file path
+ * @param reserve count degrees first, to reserve exact space for edges?
+ */
+template <class G>
+inline void readEdgelistMmapOmpW(G& a, const char *pth, bool reserve=false) {
+  auto fv = [](auto u, auto d)         { return true; };
+  auto fe = [](auto u, auto v, auto w) { return true; };
+  readEdgelistIfMmapOmpW(a, pth, fv, fe, reserve);
+}
+#endif
+#pragma endregion
+
+
+
+
+#pragma region READ EDGELIST SHARDS
+/**
+ * Split edgelist shards into line-aligned chunks of text.
+ * @param files mapped shard files
+ * @param chunk approximate size of each chunk, in bytes
+ * @returns chunks (shard index, begin, end), in order of shards
+ */
+inline vector<tuple<size_t, const char*, const char*>> splitEdgelistShards(const vector<MappedFile>& files, size_t chunk) {
+  vector<tuple<size_t, const char*, const char*>> a;
+  for (size_t i=0; i<files.size(); ++i) {
+    const char *ib = files[i].data(), *ie = ib + files[i].size();
+    for (const char *cb=ib; cb<ie;) {
+      const char *ce = alignToLine(cb, ie, cb + min(chunk, size_t(ie-cb)));
+      a.push_back({i, cb, ce});
+      cb = ce;
+    }
+  }
+  return a;
+}
+
+
+/**
+ * Infer the common header of edgelist shards, by scanning their contents.
+ * @param files mapped shard files
+ * @param sizes number of edges in each shard (output)
+ * @param weighted does it have edge weights? (updated)
+ * @param rows number of vertices, after shifting 0-based ids (updated)
+ * @param size number of edges (updated)
+ * @param zeroBased does it use 0-based vertex ids? (updated)
+ * @note Shards are parts of one graph, so vertex ids are 0-based if any shard has vertex 0.
+ */
+inline void readEdgelistShardsHeader(const vector<MappedFile>& files, vector<size_t>& sizes, bool& weighted, size_t& rows, size_t& size, bool& zeroBased) {
+  size_t S = files.size();
+  size_t lo = size_t(-1), hi = 0, m = 0;
+  sizes.assign(S, 0);
+  for (size_t i=0; i<S; ++i) {
+    const char *ib = files[i].data(), *ie = ib + files[i].size();
+    readEdgelistBodyDo(ib, ie, false, [&](auto u, auto v, auto w) {
+      lo = min(lo, min(u, v));
+      hi = max(hi, max(u, v));
+      ++sizes[i];
+    });
+    m += sizes[i];
+  }
+  weighted = false;
+  for (size_t i=0; i<S; ++i) {
+    if (sizes[i]==0) continue;
+    weighted = readEdgelistWeighted(files[i].data(), files[i].data() + files[i].size());
+    break;
+  }
+  zeroBased = m>0 && lo==0;
+  rows = m>0? hi + (zeroBased? 1 : 0) : 0;
+  size = m;
+}
+
+
+#ifdef OPENMP
+/**
+ * Infer the common header of edgelist shards, by scanning their chunks in parallel.
+ * @param files mapped shard files
+ * @param chunks line-aligned chunks of shards (see splitEdgelistShards)
+ * @param sizes number of edges in each shard (output)
+ * @param weighted does it have edge weights? (updated)
+ * @param rows number of vertices, after shifting 0-based ids (updated)
+ * @param size number of edges (updated)
+ * @param zeroBased does it use 0-based vertex ids? (updated)
+ * @note Shards are parts of one graph, so vertex ids are 0-based if any shard has vertex 0.
+ */
+inline void readEdgelistShardsHeaderOmp(const vector<MappedFile>& files, const vector<tuple<size_t, const char*, const char*>>& chunks, vector<size_t>& sizes, bool& weighted, size_t& rows, size_t& size, bool& zeroBased) {
+  size_t S = files.size();
+  size_t C = chunks.size();
+  size_t lo = size_t(-1), hi = 0, m = 0;
+  sizes.assign(S, 0);
+  #pragma omp parallel for schedule(dynamic, 1) reduction(min:lo) reduction(max:hi) reduction(+:m)
+  for (size_t c=0; c<C; ++c) {
+    auto [i, cb, ce] = chunks[c];
+    size_t n = 0;
+    readEdgelistBodyDo(cb, ce, false, [&](auto u, auto v, auto w) {
+      lo = min(lo, min(u, v));
+      hi = max(hi, max(u, v));
+      ++n;
+    });
+    #pragma omp atomic
+    sizes[i] += n;
+    m += n;
+  }
+  weighted = false;
+  for (size_t i=0; i<S; ++i) {
+    if (sizes[i]==0) continue;
+    weighted = readEdgelistWeighted(files[i].data(), files[i].data() + files[i].size());
+    break;
+  }
+  zeroBased = m>0 && lo==0;
+  rows = m>0? hi + (zeroBased? 1 : 0) : 0;
+  size = m;
+}
+#endif
+
+
+/**
+ * Read edgelist shard files (parts of one graph) as a graph, by mapping them to memory.
+ * @param a output graph (updated)
+ * @param pths file paths of shards
+ * @param fp on shard read (shard index, edges, bytes, seconds)
+ * @note Shards are read one after the other; the time reported for each shard
+ * is the time taken to read it.
+ */
+template <class G, class FP>
+inline void readEdgelistShardsW(G& a, const vector<string>& pths, FP fp) {
+  using K = typename G::key_type;
+  using V = typename G::vertex_value_type;
+  using E = typename G::edge_value_type;
+  size_t S = pths.size();
+  vector<MappedFile> files(S);
+  for (size_t i=0; i<S; ++i) {
+    files[i].open(pths[i].c_str());
+    files[i].adviseSequential();
+  }
+  vector<size_t> sizes;
+  bool weighted, zeroBased; size_t rows, size;
+  readEdgelistShardsHeader(files, sizes, weighted, rows, size, zeroBased);
+  a.reserve(rows+1, rows==0? 0 : (size + rows - 1) / rows);
+  addVerticesU(a, K(1), K(rows+1), V());
+  size_t b = zeroBased? 1 : 0;
+  for (size_t i=0; i<S; ++i) {
+    auto t0 = timeNow();
+    const char *ib = files[i].data(), *ie = ib + files[i].size();
+    readEdgelistBodyDo(ib, ie, weighted, [&](auto u, auto v, auto w) {
+      a.addEdge(K(u+b), K(v+b), E(w));
+    });
+    size_t bytes = files[i].size();
+    files[i].close();
+    fp(i, sizes[i], bytes, duration(t0) / 1000.0);
+  }
+  a.update();
+}
+
+
+#ifdef OPENMP
+/**
+ * Read edgelist shard files (parts of one graph) as a graph, by mapping them to memory.
+ * @param a output graph (updated)
+ * @param pths file paths of shards
+ * @param fp on shard read (shard index, edges, bytes, seconds)
+ * @note All shards are split into line-aligned chunks, which threads take in
+ * turns, so that several shards are read at once. Parsed edges are handed to
+ * the threads that own their source or target vertex (see belongsOmp). A
+ * shard is reported as soon as its last chunk is parsed; the time reported is
+ * since its first chunk began to be parsed.
+ */
+template <class G, class FP>
+inline void readEdgelistShardsOmpW(G& a, const vector<string>& pths, FP fp) {
+  using K = typename G::key_type;
+  using V = typename G::vertex_value_type;
+  using E = typename G::edge_value_type;
+  const int    THREADS = omp_get_max_threads();
+  const size_t CHUNK   = size_t(1) << 24;
+  size_t S = pths.size();
+  vector<MappedFile> files(S);
+  for (size_t i=0; i<S; ++i) {
+    files[i].open(pths[i].c_str());
+    files[i].adviseSequential();
+  }
+  auto chunks = splitEdgelistShards(files, CHUNK);
+  vector<size_t> sizes;
+  bool weighted, zeroBased; size_t rows, size;
+  readEdgelistShardsHeaderOmp(files, chunks, sizes, weighted, rows, size, zeroBased);
+  a.reserve(rows+1);
+  size_t deg = rows? (size + rows - 1) / rows : 0;
+  #pragma omp parallel for schedule(static, 2048)
+  for (size_t u=1; u<=rows; ++u)
+    a.reserveEdges(K(u), deg);
+  addVerticesU(a, K(1), K(rows+1), V());
+  // Count chunks left to read in each shard, and find its first chunk.
+  size_t C = chunks.size();
+  vector<size_t> pending(S), first(S);
+  for (size_t c=C; c>0; --c) {
+    size_t i = get<0>(chunks[c-1]);
+    ++pending[i];
+    first[i] = c-1;
+  }
+  for (size_t i=0; i<S; ++i)
+    if (pending[i]==0) fp(i, sizes[i], files[i].size(), 0.0);
+  // Read chunks in rounds, one chunk per thread, and add edges on their owner threads.
+  size_t b = zeroBased? 1 : 0;
+  vector<decltype(timeNow())> starts(S);
+  vector<vector2d<tuple<size_t, size_t, double>>> edges(THREADS, vector2d<tuple<size_t, size_t, double>>(THREADS));
+  #pragma omp parallel
+  {
+    int T = omp_get_num_threads();
+    int t = omp_get_thread_num();
+    for (size_t r=0; r<C; r+=T) {
+      clearBucketedEdgesOmpU(edges);
+      size_t c = r + t;
+      if (c<C) {
+        auto [i, cb, ce] = chunks[c];
+        if (c==first[i]) starts[i] = timeNow();
+        readEdgelistBodyDo(cb, ce, weighted, [&](auto u, auto v, auto w) { bucketEdgeOmpU(edges[t], u+b, v+b, w); });
+        size_t left;
+        // Sequentially consistent, so that the start time of the shard is seen by the thread that reports it.
+        #pragma omp atomic capture seq_cst
+        left = --pending[i];
+        if (left==0) {
+          float time = duration(starts[i]) / 1000.0;
+          #pragma omp critical
+          fp(i, sizes[i], files[i].size(), time);
+        }
+      }
+      #pragma omp barrier
+      forEachBucketedEdgeOmp(edges, [&](auto u, auto v, auto w) { addEdgeOmpU(a, K(u), K(v), E(w)); });
+      // Wait for buckets to be drained, before they are cleared.
+      #pragma omp barrier
+    }
+  }
+  updateOmpU(a);
+}
+#endif
+#pragma endregion
+
+
+
+
+#pragma region READ EDGELIST CSR
+/**
+ * Read edgelist file as a CSR graph, by mapping it to memory.
+ * @param a output graph (updated)
+ * @param pth file path
+ * @note Vertex ids are 1-based, as with other readers, so vertex 0 has no edges.
+ */
+template <class G>
+inline void readEdgelistCsrW(G& a, const char *pth) {
+  MappedFile file(pth);
+  file.adviseSequential();
+  string_view data = file.view();
+  bool weighted, zeroBased; size_t rows, size;
+  readEdgelistHeader(data, weighted, rows, size, zeroBased);
+  a.respan(rows+1);
+  readEdgelistBodyCsrW(a, data.data(), data.data() + data.size(), weighted, false, zeroBased? 1 : 0);
+}
+
+
+#ifdef OPENMP
+/**
+ * Read edgelist file as a CSR graph in parallel, by mapping it to memory.
+ * @param a output graph (updated)
+ * @param pth file path
+ * @note Vertex ids are 1-based, as with other readers, so vertex 0 has no edges.
+ */
+template <class G>
+inline void readEdgelistCsrOmpW(G& a, const char *pth) {
+  MappedFile file(pth);
+  file.adviseSequential();
+  string_view data = file.view();
+  bool weighted, zeroBased; size_t rows, size;
+  readEdgelistHeaderOmp(data, weighted, rows, size, zeroBased);
+  a.respan(rows+1);
+  readEdgelistBodyCsrOmpW(a, data.data(), data.data() + data.size(), weighted, false, zeroBased? 1 : 0);
+}
+#endif
+#pragma endregion
+
+
+
+
+#pragma region WRITE EDGELIST
+/**
+ * Format the edges of a range of vertices as edgelist lines (u, v, [w]), if test passes.
+ * @param buf text buffer, grown as needed (updated)
+ * @param x graph
+ * @param ub begin vertex
+ * @param ue end vertex (excluding)
+ * @param weighted write edge weights?
+ * @param fe include edge? (u, v, w)
+ * @param n number of characters already in buffer, to append after
+ * @returns number of characters in buffer
+ * @note Numbers are formatted with to_chars, so no strings are allocated per
+ * edge, and a reused buffer is grown only rarely.
+ */
+template <class G, class K, class FE>
+inline size_t formatEdgelistIfW(vector<char>& buf, const G& x, K ub, K ue, bool weighted, FE fe, size_t n=0) {
+  const size_t LINE = 128;  // Upper bound on the length of a line.
+  for (K u=ub; u<ue; ++u) {
+    if (!x.hasVertex(u)) continue;
+    x.forEachEdge(u, [&](auto v, auto w) {
+      if (!fe(u, v, w)) return;
+      if (buf.size()-n < LINE) buf.resize(max(2*buf.size(), n + LINE));
+      char *it = buf.data() + n, *ie = buf.data() + buf.size();
+      it = to_chars(it, ie, u).ptr; *(it++) = ' ';
+      it = to_chars(it, ie, v).ptr;
+      if (weighted) { *(it++) = ' '; it = to_chars(it, ie, w).ptr; }
+      *(it++) = '\n';
+      n = it - buf.data();
+    });
+  }
+  return n;
+}
+
+
+/**
+ * Write the edges of a graph as edgelist lines (u, v, [w]), if test passes.
+ * @param a output stream
+ * @param x graph
+ * @param weighted write edge weights?
+ * @param fe include edge? (u, v, w)
+ */
+template <class G, class FE>
+inline void writeEdgelistIf(ostream& a, const G& x, bool weighted, FE fe) {
+  using K = typename G::key_type;
+  const size_t CHUNK = size_t(1) << 16;  // Edges formatted at a time.
+  vector<char> buf;
+  K S = x.span();
+  for (K ub=0; ub<S;) {
+    K ue = ub;
+    for (size_t m=0; ue<S && m<CHUNK; ++ue)
+      m += x.degree(ue);
+    size_t n = formatEdgelistIfW(buf, x, ub, ue, weighted, fe);
+    a.write(buf.data(), n);
+    ub = ue;
+  }
+}
+
+
+/**
+ * Write the edges of some vertices of a graph as edgelist lines (u, v, [w]).
+ * @param a output stream
+ * @param x graph
+ * @param vertices vertices whose edges to write, in order
+ * @param weighted write edge weights?
+ */
+template <class G, class K>
+inline void writeEdgelistVertices(ostream& a, const G& x, const vector<K>& vertices, bool weighted=true) {
+  const size_t BYTES = size_t(1) << 20;  // Characters formatted before a write.
+  auto fe = [](auto u, auto v, auto w) { return true; };
+  vector<char> buf;
+  size_t n = 0;
+  for (K u : vertices) {
+    n = formatEdgelistIfW(buf, x, u, K(u+1), weighted, fe, n);
+    if (n < BYTES) continue;
+    a.write(buf.data(), n);
+    n = 0;
+  }
+  a.write(buf.data(), n);
+}
+
+
+#ifdef OPENMP
+/**
+ * Write the edges of a graph as edgelist lines (u, v, [w]) if test passes, formatting them in parallel.
+ * @param a output stream
+ * @param x graph
+ * @param weighted write edge weights?
+ * @param fe include edge? (u, v, w)
+ * @note Vertices are split into ranges with about the same number of edges.
+ * In each round, threads format a range each into their own buffer, while
+ * the buffers of the previous round are written to the stream in order, by
+ * an asynchronous task. Output is identical to that of writeEdgelistIf().
+ */
+template <class G, class FE>
+inline void writeEdgelistIfOmp(ostream& a, const G& x, bool weighted, FE fe) {
+  using K = typename G::key_type;
+  const int    T     = omp_get_max_threads();
+  const size_t CHUNK = size_t(1) << 16;  // Edges formatted at a time, per thread.
+  // Split vertices into ranges of about CHUNK edges.
+  K S = x.span();
+  vector<K> bounds {0};
+  for (K u=0; u<S;) {
+    for (size_t m=0; u<S && m<CHUNK; ++u)
+      m += x.degree(u);
+    bounds.push_back(u);
+  }
+  size_t C = bounds.size() - 1;
+  // Format ranges in rounds, and write each round while the next is formatted.
+  vector<vector<char>> bufs(2*T);
+  vector<size_t> sizes(2*T);
+  future<void> written;
+  for (size_t r=0, p=0; r<C; r+=T, p^=1) {
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int t=0; t<T; ++t) {
+      size_t c = r + t;
+      sizes[p*T+t] = c<C? formatEdgelistIfW(bufs[p*T+t], x, bounds[c], bounds[c+1], weighted, fe) : 0;
+    }
+    if (written.valid()) written.get();
+    written = async(launch::async, [&, p]() {
+      for (int t=0; t<T; ++t)
+        a.write(bufs[p*T+t].data(), sizes[p*T+t]);
+    });
+  }
+  if (written.valid()) written.get();
+}
+#endif
+
+
+/**
+ * Write the edges of a graph as edgelist lines (u, v, [w]).
+ * @param a output stream
+ * @param x graph
+ * @param weighted write edge weights?
+ */
+template <class G>
+inline void writeEdgelist(ostream& a, const G& x, bool weighted=true) {
+  auto fe = [](auto u, auto v, auto w) { return true; };
+  writeEdgelistIf(a, x, weighted, fe);
+}
+
+
+#ifdef OPENMP
+/**
+ * Write the edges of a graph as edgelist lines (u, v, [w]), formatting them in parallel.
+ * @param a output stream
+ * @param x graph
+ * @param weighted write edge weights?
+ */
+template <class G>
+inline void writeEdgelistOmp(ostream& a, const G& x, bool weighted=true) {
+  auto fe = [](auto u, auto v, auto w) { return true; };
+  writeEdgelistIfOmp(a, x, weighted, fe);
+}
+#endif
+#pragma endregion
+#pragma endregion
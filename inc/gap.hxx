@@ -0,0 +1,360 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <ostream>
+#include <stdexcept>
+#include "_main.hxx"
+#include "Graph.hxx"
+#include "csr.hxx"
+#include "symmetrize.hxx"
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+using std::string;
+using std::string_view;
+using std::vector;
+using std::ostream;
+using std::runtime_error;
+
+
+
+
+#pragma region CLASSES
+/**
+ * Size of the header of a GAP serialized graph (.sg, .wsg), in bytes.
+ * @details The header has, in order and unpadded: is the graph directed
+ * (bool), number of edges (int64), and number of vertices (int64). It is
+ * followed by the outgoing edges of all vertices, as offsets ((N+1) x int64)
+ * and neighbors (M x int32, or M x (int32, int32) with weights in a .wsg).
+ * If the graph is directed, incoming edges follow in the same layout. Vertex
+ * ids are 0-based, and all values are stored in native byte order.
+ */
+#define GAP_HEADER_BYTES 17
+#pragma endregion
+
+
+
+
+#pragma region METHODS
+#pragma region GAP HEADER
+/**
+ * Check if a GAP serialized graph file is weighted, by its extension (as GAP does).
+ * @param pth path to file
+ * @returns does it end with .wsg?
+ */
+inline bool isGapWeighted(const string& pth) {
+  return pth.size()>=4 && pth.compare(pth.size()-4, 4, ".wsg")==0;
+}
+
+
+/**
+ * Get the size of the outgoing (or incoming) edges of a GAP serialized graph.
+ * @param order number of vertices
+ * @param size number of edges
+ * @param weighted are edge weights stored?
+ * @returns size in bytes
+ */
+inline size_t gapSectionBytes(size_t order, size_t size, bool weighted) {
+  return (order+1) * sizeof(int64_t) + size * (weighted? 2 : 1) * sizeof(int32_t);
+}
+
+
+/**
+ * Read the header of a GAP serialized graph.
+ * @param data file contents
+ * @param directed is the graph directed? (output)
+ * @param order number of vertices (output)
+ * @param size number of edges (output)
+ * @param weighted are edge weights stored?
+ * @returns is the file large enough for the graph it describes?
+ */
+inline bool readGapHeader(string_view data, bool& directed, size_t& order, size_t& size, bool weighted) {
+  if (data.size() < GAP_HEADER_BYTES) return false;
+  int64_t m = 0, n = 0;
+  directed = data[0]!=0;
+  memcpy(&m, data.data() + 1, sizeof(int64_t));
+  memcpy(&n, data.data() + 9, sizeof(int64_t));
+  if (m<0 || n<0) return false;
+  order = size_t(n);
+  size  = size_t(m);
+  return data.size() >= GAP_HEADER_BYTES + (directed? 2 : 1) * gapSectionBytes(order, size, weighted);
+}
+#pragma endregion
+
+
+
+
+#pragma region READ GAP
+/**
+ * Read the outgoing (or incoming) edges of a GAP serialized graph, as a CSR graph.
+ * @param a CSR graph (output)
+ * @param data beginning of edges section
+ * @param order number of vertices
+ * @param size number of edges
+ * @param weighted are edge weights stored? (else weights are 1)
+ * @returns are offsets and vertex ids valid?
+ * @note Values are unaligned in the file, so they are copied one at a time.
+ */
+template <class K, class V, class E, class O>
+inline bool readGapSectionW(DiGraphCsr<K, V, E, O>& a, const char *data, size_t order, size_t size, bool weighted) {
+  const char *offsets = data;
+  const char *neighs  = data + (order+1) * sizeof(int64_t);
+  const size_t D = (weighted? 2 : 1) * sizeof(int32_t);
+  a.respan(order);
+  a.edgeKeys.resize(size);
+  a.edgeValues.resize(size);
+  for (size_t u=0; u<=order; ++u) {
+    int64_t o = 0;
+    memcpy(&o, offsets + u*sizeof(int64_t), sizeof(int64_t));
+    a.offsets[u] = O(o);
+  }
+  bool valid = a.offsets[0]==0 && a.offsets[order]==O(size);
+  for (size_t u=0; u<order; ++u) {
+    valid &= a.offsets[u] <= a.offsets[u+1];
+    a.degrees[u] = K(a.offsets[u+1] - a.offsets[u]);
+  }
+  for (size_t i=0; i<size; ++i) {
+    int32_t v = 0, w = 1;
+    memcpy(&v, neighs + i*D, sizeof(int32_t));
+    if (weighted) memcpy(&w, neighs + i*D + sizeof(int32_t), sizeof(int32_t));
+    valid &= v>=0 && size_t(v)<order;
+    a.edgeKeys[i]   = K(v);
+    a.edgeValues[i] = E(w);
+  }
+  return valid;
+}
+
+
+#ifdef OPENMP
+/**
+ * Read the outgoing (or incoming) edges of a GAP serialized graph, as a CSR graph, in parallel.
+ * @param a CSR graph (output)
+ * @param data beginning of edges section
+ * @param order number of vertices
+ * @param size number of edges
+ * @param weighted are edge weights stored? (else weights are 1)
+ * @returns are offsets and vertex ids valid?
+ * @note Values are unaligned in the file, so they are copied one at a time.
+ */
+template <class K, class V, class E, class O>
+inline bool readGapSectionOmpW(DiGraphCsr<K, V, E, O>& a, const char *data, size_t order, size_t size, bool weighted) {
+  const char *offsets = data;
+  const char *neighs  = data + (order+1) * sizeof(int64_t);
+  const size_t D = (weighted? 2 : 1) * sizeof(int32_t);
+  a.respan(order);
+  a.edgeKeys.resize(size);
+  a.edgeValues.resize(size);
+  #pragma omp parallel for schedule(static, 2048)
+  for (size_t u=0; u<=order; ++u) {
+    int64_t o = 0;
+    memcpy(&o, offsets + u*sizeof(int64_t), sizeof(int64_t));
+    a.offsets[u] = O(o);
+  }
+  bool valid = a.offsets[0]==0 && a.offsets[order]==O(size);
+  #pragma omp parallel for schedule(static, 2048) reduction(&&:valid)
+  for (size_t u=0; u<order; ++u) {
+    valid = valid && a.offsets[u] <= a.offsets[u+1];
+    a.degrees[u] = K(a.offsets[u+1] - a.offsets[u]);
+  }
+  #pragma omp parallel for schedule(static, 2048) reduction(&&:valid)
+  for (size_t i=0; i<size; ++i) {
+    int32_t v = 0, w = 1;
+    memcpy(&v, neighs + i*D, sizeof(int32_t));
+    if (weighted) memcpy(&w, neighs + i*D + sizeof(int32_t), sizeof(int32_t));
+    valid = valid && v>=0 && size_t(v)<order;
+    a.edgeKeys[i]   = K(v);
+    a.edgeValues[i] = E(w);
+  }
+  return valid;
+}
+#endif
+
+
+/**
+ * Read a GAP serialized graph (.sg, .wsg), by mapping it to memory.
+ * @param a output graph (updated)
+ * @param pth path to file
+ * @param weighted are edge weights stored? (see isGapWeighted())
+ * @throws runtime_error if the file is not a valid GAP serialized graph
+ * @note Vertex ids are made 1-based. Edges of each vertex are sorted, and
+ * duplicates removed. For an undirected graph, incoming edges are the same
+ * as outgoing edges.
+ */
+template <class G>
+inline void readGapW(G& a, const char *pth, bool weighted) {
+  using K = typename G::key_type;
+  using E = typename G::edge_value_type;
+  MappedFile file(pth);
+  file.adviseSequential();
+  bool directed = false;
+  size_t N = 0, M = 0;
+  string error = string("Invalid GAP serialized graph: ") + pth;
+  if (!readGapHeader(file.view(), directed, N, M, weighted)) throw runtime_error(error);
+  DiGraphCsr<K, None, E> x(0, 0), xt(0, 0);
+  const char *data = file.data() + GAP_HEADER_BYTES;
+  if (!readGapSectionW(x, data, N, M, weighted)) throw runtime_error(error);
+  csrSortEdgesU(x.degrees, x.edgeKeys, x.edgeValues, x.offsets);
+  if (directed) {
+    if (!readGapSectionW(xt, data + gapSectionBytes(N, M, weighted), N, M, weighted)) throw runtime_error(error);
+    if (a.hasInEdges()) csrSortEdgesU(xt.degrees, xt.edgeKeys, xt.edgeValues, xt.offsets);
+  }
+  csrAssignGraphW(a, x, directed? xt : x, 1);
+}
+
+
+#ifdef OPENMP
+/**
+ * Read a GAP serialized graph (.sg, .wsg) in parallel, by mapping it to memory.
+ * @param a output graph (updated)
+ * @param pth path to file
+ * @param weighted are edge weights stored? (see isGapWeighted())
+ * @throws runtime_error if the file is not a valid GAP serialized graph
+ * @note Vertex ids are made 1-based. Edges of each vertex are sorted, and
+ * duplicates removed. For an undirected graph, incoming edges are the same
+ * as outgoing edges.
+ */
+template <class G>
+inline void readGapOmpW(G& a, const char *pth, bool weighted) {
+  using K = typename G::key_type;
+  using E = typename G::edge_value_type;
+  MappedFile file(pth);
+  file.adviseWillNeed();
+  bool directed = false;
+  size_t N = 0, M = 0;
+  string error = string("Invalid GAP serialized graph: ") + pth;
+  if (!readGapHeader(file.view(), directed, N, M, weighted)) throw runtime_error(error);
+  DiGraphCsr<K, None, E> x(0, 0), xt(0, 0);
+  const char *data = file.data() + GAP_HEADER_BYTES;
+  if (!readGapSectionOmpW(x, data, N, M, weighted)) throw runtime_error(error);
+  csrSortEdgesOmpU(x.degrees, x.edgeKeys, x.edgeValues, x.offsets);
+  if (directed) {
+    if (!readGapSectionOmpW(xt, data + gapSectionBytes(N, M, weighted), N, M, weighted)) throw runtime_error(error);
+    if (a.hasInEdges()) csrSortEdgesOmpU(xt.degrees, xt.edgeKeys, xt.edgeValues, xt.offsets);
+  }
+  csrAssignGraphOmpW(a, x, directed? xt : x, 1);
+}
+#endif
+#pragma endregion
+
+
+
+
+#pragma region WRITE GAP
+/**
+ * Write the outgoing (or incoming) edges of a CSR graph, in the GAP serialized layout.
+ * @param a output stream (binary)
+ * @param x CSR graph
+ * @param weighted write edge weights?
+ */
+template <class K, class V, class E, class O>
+inline void writeGapSection(ostream& a, const DiGraphCsr<K, V, E, O>& x, bool weighted) {
+  size_t N = x.order(), M = x.offsets[N];
+  const size_t D = weighted? 2 : 1;
+  vector<int64_t> offsets(N+1);
+  vector<int32_t> neighs(D * M);
+  for (size_t u=0; u<=N; ++u)
+    offsets[u] = int64_t(x.offsets[u]);
+  for (size_t i=0; i<M; ++i) {
+    neighs[D*i] = int32_t(x.edgeKeys[i]);
+    if (weighted) neighs[D*i+1] = int32_t(x.edgeValues[i]);
+  }
+  a.write((const char*) offsets.data(), offsets.size() * sizeof(int64_t));
+  a.write((const char*) neighs.data(),  neighs.size()  * sizeof(int32_t));
+}
+
+
+#ifdef OPENMP
+/**
+ * Write the outgoing (or incoming) edges of a CSR graph, in the GAP serialized layout, converting them in parallel.
+ * @param a output stream (binary)
+ * @param x CSR graph
+ * @param weighted write edge weights?
+ */
+template <class K, class V, class E, class O>
+inline void writeGapSectionOmp(ostream& a, const DiGraphCsr<K, V, E, O>& x, bool weighted) {
+  size_t N = x.order(), M = x.offsets[N];
+  const size_t D = weighted? 2 : 1;
+  vector<int64_t> offsets(N+1);
+  vector<int32_t> neighs(D * M);
+  #pragma omp parallel for schedule(static, 2048)
+  for (size_t u=0; u<=N; ++u)
+    offsets[u] = int64_t(x.offsets[u]);
+  #pragma omp parallel for schedule(static, 2048)
+  for (size_t i=0; i<M; ++i) {
+    neighs[D*i] = int32_t(x.edgeKeys[i]);
+    if (weighted) neighs[D*i+1] = int32_t(x.edgeValues[i]);
+  }
+  a.write((const char*) offsets.data(), offsets.size() * sizeof(int64_t));
+  a.write((const char*) neighs.data(),  neighs.size()  * sizeof(int32_t));
+}
+#endif
+
+
+/**
+ * Write the header of a GAP serialized graph.
+ * @param a output stream (binary)
+ * @param directed is the graph directed?
+ * @param order number of vertices
+ * @param size number of edges
+ */
+inline void writeGapHeader(ostream& a, bool directed, size_t order, size_t size) {
+  char    d = directed? 1 : 0;
+  int64_t m = int64_t(size), n = int64_t(order);
+  a.write(&d, 1);
+  a.write((const char*) &m, sizeof(int64_t));
+  a.write((const char*) &n, sizeof(int64_t));
+}
+
+
+/**
+ * Write a graph as a GAP serialized graph (.sg, or .wsg if weighted).
+ * @param a output stream (binary)
+ * @param x graph
+ * @param weighted write edge weights?
+ * @note Vertices are renumbered from 0 (see csrCreateGraphW()). A symmetric
+ * graph is written as undirected, without its incoming edges.
+ */
+template <class G>
+inline void writeGap(ostream& a, const G& x, bool weighted) {
+  using K = typename G::key_type;
+  using E = typename G::edge_value_type;
+  DiGraphCsr<K, None, E> y(0, 0), yt(0, 0);
+  csrCreateGraphW(y, x);
+  bool directed = !isSymmetric(x);
+  writeGapHeader(a, directed, y.order(), y.offsets.back());
+  writeGapSection(a, y, weighted);
+  if (!directed) return;
+  csrTransposeW(yt, y);
+  writeGapSection(a, yt, weighted);
+}
+
+
+#ifdef OPENMP
+/**
+ * Write a graph as a GAP serialized graph (.sg, or .wsg if weighted), in parallel.
+ * @param a output stream (binary)
+ * @param x graph
+ * @param weighted write edge weights?
+ * @note Vertices are renumbered from 0 (see csrCreateGraphOmpW()). A symmetric
+ * graph is written as undirected, without its incoming edges.
+ */
+template <class G>
+inline void writeGapOmp(ostream& a, const G& x, bool weighted) {
+  using K = typename G::key_type;
+  using E = typename G::edge_value_type;
+  DiGraphCsr<K, None, E> y(0, 0), yt(0, 0);
+  csrCreateGraphOmpW(y, x);
+  bool directed = !isSymmetricOmp(x);
+  writeGapHeader(a, directed, y.order(), y.offsets.back());
+  writeGapSectionOmp(a, y, weighted);
+  if (!directed) return;
+  csrTransposeOmpW(yt, y);
+  writeGapSectionOmp(a, yt, weighted);
+}
+#endif
+#pragma endregion
+#pragma endregion
@@ -0,0 +1,376 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <charconv>
+#include <ostream>
+#include <future>
+#include <stdexcept>
+#include "_main.hxx"
+#include "Graph.hxx"
+#include "csr.hxx"
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+using std::string;
+using std::string_view;
+using std::vector;
+using std::min;
+using std::max;
+using std::ostream;
+using std::future;
+using std::async;
+using std::launch;
+using std::to_chars;
+using std::runtime_error;
+
+
+
+
+#pragma region METHODS
+#pragma region READ LIGRA VALUES
+/**
+ * Read whitespace-separated integers from text.
+ * @param a read integers, or nullptr to only count them (output)
+ * @param ib begin of text
+ * @param ie end of text
+ * @returns number of integers, or -1 if some text is not an integer
+ */
+inline int64_t readLigraValuesW(int64_t *a, const char *ib, const char *ie) {
+  int64_t n = 0;
+  for (const char *it=ib; it<ie;) {
+    if (isBlank(*it) || *it=='\n') { ++it; continue; }
+    bool neg = *it=='-';
+    uint64_t x = 0;
+    const char *jt = readUintW(x, it + (neg? 1 : 0), ie);
+    if (jt==it + (neg? 1 : 0) || (jt<ie && !isBlank(*jt) && *jt!='\n')) return -1;
+    if (a) a[n] = neg? -int64_t(x) : int64_t(x);
+    ++n; it = jt;
+  }
+  return n;
+}
+
+
+/**
+ * Read the body of a Ligra adjacency graph, as integers.
+ * @param a read integers (output)
+ * @param ib begin of body
+ * @param ie end of body
+ * @returns are all values integers?
+ */
+inline bool readLigraBodyW(vector<int64_t>& a, const char *ib, const char *ie) {
+  int64_t n = readLigraValuesW(nullptr, ib, ie);
+  if (n<0) return false;
+  a.resize(n);
+  readLigraValuesW(a.data(), ib, ie);
+  return true;
+}
+
+
+#ifdef OPENMP
+/**
+ * Read the body of a Ligra adjacency graph, as integers, in parallel.
+ * @param a read integers (output)
+ * @param ib begin of body
+ * @param ie end of body
+ * @returns are all values integers?
+ * @note The body is split into line-aligned chunks. Integers are first
+ * counted in each chunk, to find where each chunk's integers go, and then
+ * read directly into place.
+ */
+inline bool readLigraBodyOmpW(vector<int64_t>& a, const char *ib, const char *ie) {
+  const size_t CHUNK = size_t(1) << 20;  // Bytes read at a time, per thread.
+  size_t C = max(size_t(1), size_t(ie-ib) / CHUNK + 1);
+  vector<const char*> bounds(C+1);
+  vector<int64_t> counts(C), offsets(C+1);
+  for (size_t c=0; c<=C; ++c)
+    bounds[c] = alignToLine(ib, ie, ib + (ie-ib) * c / C);
+  bool valid = true;
+  #pragma omp parallel for schedule(dynamic, 1) reduction(&&:valid)
+  for (size_t c=0; c<C; ++c) {
+    counts[c] = readLigraValuesW(nullptr, bounds[c], bounds[c+1]);
+    valid = valid && counts[c]>=0;
+  }
+  if (!valid) return false;
+  for (size_t c=0; c<C; ++c)
+    offsets[c+1] = offsets[c] + counts[c];
+  a.resize(offsets[C]);
+  #pragma omp parallel for schedule(dynamic, 1)
+  for (size_t c=0; c<C; ++c)
+    readLigraValuesW(a.data() + offsets[c], bounds[c], bounds[c+1]);
+  return true;
+}
+#endif
+#pragma endregion
+
+
+
+
+#pragma region READ LIGRA
+/**
+ * Read the header line of a Ligra adjacency graph.
+ * @param data file contents
+ * @param weighted is it a WeightedAdjacencyGraph? (output)
+ * @returns position of the body, or 0 if the header is invalid
+ */
+inline size_t readLigraHeader(string_view data, bool& weighted) {
+  const char *ib = data.data(), *ie = ib + data.size();
+  const char *it = findNextNonBlank(ib, ie);
+  const char *jt = it;
+  for (; jt<ie && !isBlank(*jt) && *jt!='\n'; ++jt);
+  string_view head(it, jt-it);
+  if (head!="AdjacencyGraph" && head!="WeightedAdjacencyGraph") return 0;
+  weighted = head=="WeightedAdjacencyGraph";
+  return findNextLine(jt, ie) - ib;
+}
+
+
+/**
+ * Convert the integers in the body of a Ligra adjacency graph to a CSR graph.
+ * @param a CSR graph (output)
+ * @param data integers in body (n, m, offsets, edges, [weights])
+ * @param weighted are edge weights stored? (else weights are 1)
+ * @returns are the counts, offsets, and vertex ids valid?
+ */
+template <class K, class V, class E, class O>
+inline bool readLigraCsrW(DiGraphCsr<K, V, E, O>& a, const vector<int64_t>& data, bool weighted) {
+  if (data.size()<2 || data[0]<0 || data[1]<0) return false;
+  size_t N = size_t(data[0]), M = size_t(data[1]);
+  if (data.size() != 2 + N + (weighted? 2 : 1) * M) return false;
+  const int64_t *offsets = data.data() + 2;
+  const int64_t *edges   = offsets + N;
+  const int64_t *weights = edges + M;
+  bool valid = N==0 || offsets[0]==0;
+  a.respan(N);
+  a.edgeKeys.resize(M);
+  a.edgeValues.resize(M);
+  for (size_t u=0; u<N; ++u) {
+    int64_t o = offsets[u], p = u+1<N? offsets[u+1] : int64_t(M);
+    valid &= o<=p && p<=int64_t(M);
+    a.offsets[u] = O(o);
+    a.degrees[u] = valid? K(p - o) : K();
+  }
+  a.offsets[N] = O(M);
+  for (size_t i=0; i<M; ++i) {
+    valid &= edges[i]>=0 && size_t(edges[i])<N;
+    a.edgeKeys[i]   = K(edges[i]);
+    a.edgeValues[i] = weighted? E(weights[i]) : E(1);
+  }
+  return valid;
+}
+
+
+#ifdef OPENMP
+/**
+ * Convert the integers in the body of a Ligra adjacency graph to a CSR graph, in parallel.
+ * @param a CSR graph (output)
+ * @param data integers in body (n, m, offsets, edges, [weights])
+ * @param weighted are edge weights stored? (else weights are 1)
+ * @returns are the counts, offsets, and vertex ids valid?
+ */
+template <class K, class V, class E, class O>
+inline bool readLigraCsrOmpW(DiGraphCsr<K, V, E, O>& a, const vector<int64_t>& data, bool weighted) {
+  if (data.size()<2 || data[0]<0 || data[1]<0) return false;
+  size_t N = size_t(data[0]), M = size_t(data[1]);
+  if (data.size() != 2 + N + (weighted? 2 : 1) * M) return false;
+  const int64_t *offsets = data.data() + 2;
+  const int64_t *edges   = offsets + N;
+  const int64_t *weights = edges + M;
+  bool valid = N==0 || offsets[0]==0;
+  a.respan(N);
+  a.edgeKeys.resize(M);
+  a.edgeValues.resize(M);
+  #pragma omp parallel for schedule(static, 2048) reduction(&&:valid)
+  for (size_t u=0; u<N; ++u) {
+    int64_t o = offsets[u], p = u+1<N? offsets[u+1] : int64_t(M);
+    bool ok = o<=p && p<=int64_t(M);
+    valid = valid && ok;
+    a.offsets[u] = O(o);
+    a.degrees[u] = ok? K(p - o) : K();
+  }
+  a.offsets[N] = O(M);
+  #pragma omp parallel for schedule(static, 2048) reduction(&&:valid)
+  for (size_t i=0; i<M; ++i) {
+    valid = valid && edges[i]>=0 && size_t(edges[i])<N;
+    a.edgeKeys[i]   = K(edges[i]);
+    a.edgeValues[i] = weighted? E(weights[i]) : E(1);
+  }
+  return valid;
+}
+#endif
+
+
+/**
+ * Read a Ligra adjacency graph (AdjacencyGraph, WeightedAdjacencyGraph), by mapping it to memory.
+ * @param a output graph (updated)
+ * @param pth path to file
+ * @throws runtime_error if the file is not a valid Ligra adjacency graph
+ * @note Vertex ids are made 1-based. Edges of each vertex are sorted, and
+ * duplicates removed. Weights are 1 for an unweighted graph.
+ */
+template <class G>
+inline void readLigraW(G& a, const char *pth) {
+  using K = typename G::key_type;
+  using E = typename G::edge_value_type;
+  MappedFile file(pth);
+  file.adviseSequential();
+  bool weighted = false;
+  string error = string("Invalid Ligra adjacency graph: ") + pth;
+  size_t head  = readLigraHeader(file.view(), weighted);
+  if (head==0) throw runtime_error(error);
+  vector<int64_t> data;
+  DiGraphCsr<K, None, E> x(0, 0), xt(0, 0);
+  if (!readLigraBodyW(data, file.data() + head, file.data() + file.size())) throw runtime_error(error);
+  if (!readLigraCsrW(x, data, weighted)) throw runtime_error(error);
+  data = vector<int64_t>();
+  csrSortEdgesU(x.degrees, x.edgeKeys, x.edgeValues, x.offsets);
+  if (a.hasInEdges()) csrTransposeW(xt, x);
+  csrAssignGraphW(a, x, xt, 1);
+}
+
+
+#ifdef OPENMP
+/**
+ * Read a Ligra adjacency graph (AdjacencyGraph, WeightedAdjacencyGraph) in parallel, by mapping it to memory.
+ * @param a output graph (updated)
+ * @param pth path to file
+ * @throws runtime_error if the file is not a valid Ligra adjacency graph
+ * @note Vertex ids are made 1-based. Edges of each vertex are sorted, and
+ * duplicates removed. Weights are 1 for an unweighted graph.
+ */
+template <class G>
+inline void readLigraOmpW(G& a, const char *pth) {
+  using K = typename G::key_type;
+  using E = typename G::edge_value_type;
+  MappedFile file(pth);
+  file.adviseWillNeed();
+  bool weighted = false;
+  string error = string("Invalid Ligra adjacency graph: ") + pth;
+  size_t head  = readLigraHeader(file.view(), weighted);
+  if (head==0) throw runtime_error(error);
+  vector<int64_t> data;
+  DiGraphCsr<K, None, E> x(0, 0), xt(0, 0);
+  if (!readLigraBodyOmpW(data, file.data() + head, file.data() + file.size())) throw runtime_error(error);
+  if (!readLigraCsrOmpW(x, data, weighted)) throw runtime_error(error);
+  data = vector<int64_t>();
+  csrSortEdgesOmpU(x.degrees, x.edgeKeys, x.edgeValues, x.offsets);
+  if (a.hasInEdges()) csrTransposeOmpW(xt, x);
+  csrAssignGraphOmpW(a, x, xt, 1);
+}
+#endif
+#pragma endregion
+
+
+
+
+#pragma region WRITE LIGRA
+/**
+ * Format a range of values of a Ligra adjacency graph, one per line.
+ * @param buf text buffer, grown as needed (updated)
+ * @param x CSR graph, without gaps in its edges
+ * @param ib index of begin value
+ * @param ie index of end value (excluding)
+ * @returns number of characters formatted
+ * @note Values are the offsets of the N vertices, then the M edge keys, and
+ * then the M edge values (see writeLigra()).
+ */
+template <class K, class V, class E, class O>
+inline size_t formatLigraW(vector<char>& buf, const DiGraphCsr<K, V, E, O>& x, size_t ib, size_t ie) {
+  const size_t LINE = 32;  // Upper bound on the length of a line.
+  size_t N = x.order(), M = x.offsets[N];
+  if (buf.size() < (ie-ib) * LINE) buf.resize((ie-ib) * LINE);
+  char *it = buf.data(), *bend = buf.data() + buf.size();
+  for (size_t i=ib; i<ie; ++i) {
+    if      (i<N)   it = to_chars(it, bend, x.offsets[i]).ptr;
+    else if (i<N+M) it = to_chars(it, bend, x.edgeKeys[i-N]).ptr;
+    else            it = to_chars(it, bend, x.edgeValues[i-N-M]).ptr;
+    *(it++) = '\n';
+  }
+  return it - buf.data();
+}
+
+
+/**
+ * Write the header of a Ligra adjacency graph.
+ * @param a output stream
+ * @param order number of vertices
+ * @param size number of edges
+ * @param weighted is it a WeightedAdjacencyGraph?
+ */
+inline void writeLigraHeader(ostream& a, size_t order, size_t size, bool weighted) {
+  a << (weighted? "WeightedAdjacencyGraph" : "AdjacencyGraph") << "\n";
+  a << order << "\n" << size << "\n";
+}
+
+
+/**
+ * Write a graph as a Ligra adjacency graph (AdjacencyGraph, or WeightedAdjacencyGraph if weighted).
+ * @param a output stream
+ * @param x graph
+ * @param weighted write edge weights?
+ * @note Vertices are renumbered from 0 (see csrCreateGraphW()).
+ */
+template <class G>
+inline void writeLigra(ostream& a, const G& x, bool weighted) {
+  using K = typename G::key_type;
+  using E = typename G::edge_value_type;
+  const size_t CHUNK = size_t(1) << 16;  // Values formatted at a time.
+  DiGraphCsr<K, None, E> y(0, 0);
+  csrCreateGraphW(y, x);
+  size_t N = y.order(), M = y.offsets[N];
+  size_t L = N + (weighted? 2 : 1) * M;
+  vector<char> buf;
+  writeLigraHeader(a, N, M, weighted);
+  for (size_t ib=0; ib<L; ib+=CHUNK) {
+    size_t n = formatLigraW(buf, y, ib, min(ib+CHUNK, L));
+    a.write(buf.data(), n);
+  }
+}
+
+
+#ifdef OPENMP
+/**
+ * Write a graph as a Ligra adjacency graph (AdjacencyGraph, or WeightedAdjacencyGraph if weighted), formatting it in parallel.
+ * @param a output stream
+ * @param x graph
+ * @param weighted write edge weights?
+ * @note Vertices are renumbered from 0 (see csrCreateGraphOmpW()). In each
+ * round, threads format a chunk of values each into their own buffer, while
+ * the buffers of the previous round are written to the stream in order, by
+ * an asynchronous task. Output is identical to that of writeLigra().
+ */
+template <class G>
+inline void writeLigraOmp(ostream& a, const G& x, bool weighted) {
+  using K = typename G::key_type;
+  using E = typename G::edge_value_type;
+  const int    T     = omp_get_max_threads();
+  const size_t CHUNK = size_t(1) << 16;  // Values formatted at a time, per thread.
+  DiGraphCsr<K, None, E> y(0, 0);
+  csrCreateGraphOmpW(y, x);
+  size_t N = y.order(), M = y.offsets[N];
+  size_t L = N + (weighted? 2 : 1) * M;
+  size_t C = (L + CHUNK-1) / CHUNK;
+  vector<vector<char>> bufs(2*T);
+  vector<size_t> sizes(2*T);
+  future<void> written;
+  writeLigraHeader(a, N, M, weighted);
+  for (size_t r=0, p=0; r<C; r+=T, p^=1) {
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int t=0; t<T; ++t) {
+      size_t c = r + t;
+      sizes[p*T+t] = c<C? formatLigraW(bufs[p*T+t], y, c*CHUNK, min((c+1)*CHUNK, L)) : 0;
+    }
+    if (written.valid()) written.get();
+    written = async(launch::async, [&, p]() {
+      for (int t=0; t<T; ++t)
+        a.write(bufs[p*T+t].data(), sizes[p*T+t]);
+    });
+  }
+  if (written.valid()) written.get();
+}
+#endif
+#pragma endregion
+#pragma endregion
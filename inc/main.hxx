@@ -4,9 +4,14 @@
 #include "_main.hxx"
 #include "Graph.hxx"
 #include "update.hxx"
+#include "edgelist.hxx"
 #include "mtx.hxx"
 #include "snap.hxx"
+#include "snapshot.hxx"
+#include "ligra.hxx"
+#include "gap.hxx"
 #include "batch.hxx"
+#include "delta.hxx"
 #include "duplicate.hxx"
 #include "symmetrize.hxx"
 #include "selfLoop.hxx"
@@ -1,27 +1,39 @@
 #pragma once
 #include <utility>
 #include <string>
+#include <string_view>
 #include <istream>
 #include <sstream>
 #include <fstream>
 #include <algorithm>
+#include <type_traits>
+#include <ostream>
 #include <cstdlib>
+#include <stdexcept>
 #include "_main.hxx"
 #include "Graph.hxx"
 #include "update.hxx"
+#include "edgelist.hxx"
+#include "symmetrize.hxx"
 #ifdef OPENMP
 #include <omp.h>
 #endif
 
 using std::tuple;
 using std::string;
+using std::string_view;
 using std::istream;
 using std::istringstream;
 using std::ifstream;
 using std::ofstream;
 using std::move;
+using std::min;
 using std::max;
 using std::getline;
+using std::ostream;
+using std::is_same_v;
+using std::is_integral_v;
+using std::runtime_error;
 
 
 
@@ -58,6 +70,34 @@ inline void readMtxHeader(const char* pth, bool& symmetric, size_t& rows, size_t
 }
 
 
+/**
+ * Read header of MTX file.
+ * @param data file contents
+ * @param symmetric is graph symmetric (updated)
+ * @param rows number of rows (updated)
+ * @param cols number of columns (updated)
+ * @param size number of lines/edges (updated)
+ * @returns offset of the body in file contents
+ */
+inline size_t readMtxHeader(string_view data, bool& symmetric, size_t& rows, size_t& cols, size_t& size) {
+  const char *ib = data.data(), *ie = ib + data.size(), *it = ib;
+  string h0, h1, h2, h3, h4;
+  // Skip past the comments and read the graph type.
+  for (; it<ie && *it=='%'; it=findNextLine(it, ie)) {
+    if (it+1>=ie || *(it+1)!='%') continue;
+    istringstream sline(string(it, findNextLine(it, ie)));
+    sline >> h0 >> h1 >> h2 >> h3 >> h4;
+  }
+  if (h1!="matrix" || h2!="coordinate") { symmetric = false; rows = 0; cols = 0; size = 0; return it - ib; }
+  symmetric = h4=="symmetric" || h4=="skew-symmetric";
+  // Read rows, cols, size.
+  it = readUintW(rows, findNextNonBlank(it, ie), ie);
+  it = readUintW(cols, findNextNonBlank(it, ie), ie);
+  it = readUintW(size, findNextNonBlank(it, ie), ie);
+  return findNextLine(it, ie) - ib;
+}
+
+
 /**
  * Read order of graph in MTX file.
  * @param s input stream
@@ -126,9 +166,7 @@ inline void readMtxDo(istream& s, bool weighted, FH fh, FB fb) {
   string line;
   while (getline(s, line)) {
     size_t u, v; double w = 1;
-    istringstream sline(line);
-    if (!(sline >> u >> v)) break;
-    if (weighted) sline >> w;
+    if (!readEdgelistLineW(u, v, w, line, weighted)) break;
     fb(u, v, w);
     if (symmetric) fb(v, u, w);
   }
@@ -147,49 +185,146 @@ inline void readMtxDo(const char *pth, bool weighted, FH fh, FB fb) {
  * @param weighted is it weighted?
  * @param fh on header (symmetric, rows, cols, size)
  * @param fb on body line (u, v, w)
+ * @param block number of lines to read at a time
+ * @note Each edge is notified only on the threads that own its source or
+ * target vertex (see belongsOmp). The next block of lines is read while the
+ * current one is being processed (see readLinesAsyncDo).
  */
 template <class FH, class FB>
-inline void readMtxDoOmp(istream& s, bool weighted, FH fh, FB fb) {
+inline void readMtxDoOmp(istream& s, bool weighted, FH fh, FB fb, size_t block=READ_BLOCK_LINES) {
   bool symmetric; size_t rows, cols, size;
   readMtxHeader(s, symmetric, rows, cols, size);
   fh(symmetric, rows, cols, size);
   size_t n = max(rows, cols);
   if (n==0) return;
-  // Process body lines in parallel.
+  // Process body lines in parallel, while reading the next block.
   const int THREADS = omp_get_max_threads();
-  const int LINES   = 131072;
-  vector<string> lines(LINES);
-  vector<tuple<size_t, size_t, double>> edges(LINES);
-  while (true) {
-    // Read several lines from the stream.
-    int READ = 0;
-    for (int i=0; i<LINES; ++i, ++READ)
-      if (!getline(s, lines[i])) break;
-    if (READ==0) break;
-    // Parse lines using multiple threads.
-    #pragma omp parallel for schedule(dynamic, 1024)
-    for (int i=0; i<READ; ++i) {
-      char *line = (char*) lines[i].c_str();
-      size_t u = strtoull(line, &line, 10);
-      size_t v = strtoull(line, &line, 10);
-      double w = weighted? strtod(line, &line) : 0;
-      edges[i] = {u, v, w? w : 1};
-    }
-    // Notify parsed lines.
+  vector<vector2d<tuple<size_t, size_t, double>>> edges(THREADS, vector2d<tuple<size_t, size_t, double>>(THREADS));
+  readLinesAsyncDo(s, size_t(-1), block, [&](const vector<string>& lines, size_t READ) {
     #pragma omp parallel
     {
-      for (int i=0; i<READ; ++i) {
-        const auto& [u, v, w] = edges[i];
+      // Parse lines using multiple threads, and bucket them by owner thread.
+      clearBucketedEdgesOmpU(edges);
+      int t = omp_get_thread_num();
+      #pragma omp for schedule(dynamic, 1024)
+      for (size_t i=0; i<READ; ++i) {
+        size_t u, v; double w = 0;
+        if (!readEdgelistLineW(u, v, w, lines[i], weighted)) continue;
+        bucketEdgeOmpU(edges[t], u, v, w? w : 1);
+      }
+      // Notify parsed lines, to their owner threads only.
+      forEachBucketedEdgeOmp(edges, [&](auto u, auto v, auto w) {
         fb(u, v, w);
         if (symmetric) fb(v, u, w);
-      }
+      });
     }
-  }
+  });
 }
 template <class FH, class FB>
-inline void readMtxDoOmp(const char *pth, bool weighted, FH fh, FB fb) {
+inline void readMtxDoOmp(const char *pth, bool weighted, FH fh, FB fb, size_t block=READ_BLOCK_LINES) {
   ifstream s(pth);
-  readMtxDoOmp(s, weighted, fh, fb);
+  readMtxDoOmp(s, weighted, fh, fb, block);
+}
+#endif
+#pragma endregion
+
+
+
+
+#pragma region READ MTX DEGREES
+/**
+ * Count the out- and in-degree of each vertex in an MTX file, by mapping it to memory.
+ * @param degrees out-degree of each vertex (output)
+ * @param inDegrees in-degree of each vertex (output)
+ * @param pth file path
+ */
+template <class K>
+inline void readMtxDegreesW(vector<K>& degrees, vector<K>& inDegrees, const char *pth) {
+  MappedFile file(pth);
+  file.adviseSequential();
+  string_view data = file.view();
+  bool symmetric; size_t rows, cols, size;
+  size_t b = readMtxHeader(data, symmetric, rows, cols, size);
+  size_t n = max(rows, cols);
+  degrees.assign(n+1, K());
+  inDegrees.assign(n+1, K());
+  readEdgelistDegreesW(degrees, inDegrees, data.data() + b, data.data() + data.size(), symmetric, 0);
+}
+
+
+#ifdef OPENMP
+/**
+ * Count the out- and in-degree of each vertex in an MTX file in parallel, by mapping it to memory.
+ * @param degrees out-degree of each vertex (output)
+ * @param inDegrees in-degree of each vertex (output)
+ * @param pth file path
+ */
+template <class K>
+inline void readMtxDegreesOmpW(vector<K>& degrees, vector<K>& inDegrees, const char *pth) {
+  MappedFile file(pth);
+  file.adviseSequential();
+  string_view data = file.view();
+  bool symmetric; size_t rows, cols, size;
+  size_t b = readMtxHeader(data, symmetric, rows, cols, size);
+  size_t n = max(rows, cols);
+  degrees.assign(n+1, K());
+  inDegrees.assign(n+1, K());
+  readEdgelistDegreesOmpW(degrees, inDegrees, data.data() + b, data.data() + data.size(), symmetric, 0);
+}
+#endif
+#pragma endregion
+
+
+
+
+#pragma region READ MTX DO MMAP
+/**
+ * Read contents of MTX file, by mapping it to memory.
+ * @param pth file path
+ * @param weighted is it weighted?
+ * @param fh on header (symmetric, rows, cols, size)
+ * @param fb on body line (u, v, w)
+ */
+template <class FH, class FB>
+inline void readMtxDoMmap(const char *pth, bool weighted, FH fh, FB fb) {
+  MappedFile file(pth);
+  file.adviseSequential();
+  string_view data = file.view();
+  bool symmetric; size_t rows, cols, size;
+  size_t b = readMtxHeader(data, symmetric, rows, cols, size);
+  fh(symmetric, rows, cols, size);
+  size_t n = max(rows, cols);
+  if (n==0) return;
+  // Process body lines sequentially.
+  readEdgelistBodyDo(data.data() + b, data.data() + data.size(), weighted, [&](auto u, auto v, auto w) {
+    fb(u, v, w);
+    if (symmetric) fb(v, u, w);
+  });
+}
+
+
+#ifdef OPENMP
+/**
+ * Read contents of MTX file, by mapping it to memory.
+ * @param pth file path
+ * @param weighted is it weighted?
+ * @param fh on header (symmetric, rows, cols, size)
+ * @param fb on body line (u, v, w)
+ * @note The body is split into line-aligned byte ranges, one per thread,
+ * which are parsed in place (see readEdgelistBodyDoOmp).
+ */
+template <class FH, class FB>
+inline void readMtxDoMmapOmp(const char *pth, bool weighted, FH fh, FB fb) {
+  MappedFile file(pth);
+  file.adviseSequential();
+  string_view data = file.view();
+  bool symmetric; size_t rows, cols, size;
+  size_t b = readMtxHeader(data, symmetric, rows, cols, size);
+  fh(symmetric, rows, cols, size);
+  size_t n = max(rows, cols);
+  if (n==0) return;
+  // Process body lines in parallel.
+  readEdgelistBodyDoOmp(data.data() + b, data.data() + data.size(), weighted, symmetric, fb);
 }
 #endif
 #pragma endregion
@@ -231,21 +366,89 @@ inline void readMtxIfW(G &a, const char *pth, bool weighted, FV fv, FE fe) {
  * @param weighted is it weighted?
  * @param fv include vertex? (u, d)
  * @param fe include edge? (u, v, w)
+ * @param block number of lines to read at a time
+ * @note Entries beyond the dimensions in the header are skipped, as the graph
+ * cannot grow while edges are added in parallel.
  */
 template <class G, class FV, class FE>
-inline void readMtxIfOmpW(G &a, istream& s, bool weighted, FV fv, FE fe) {
+inline void readMtxIfOmpW(G &a, istream& s, bool weighted, FV fv, FE fe, size_t block=READ_BLOCK_LINES) {
   using K = typename G::key_type;
   using V = typename G::vertex_value_type;
   using E = typename G::edge_value_type;
-  auto fh = [&](auto symmetric, auto rows, auto cols, auto size) { addVerticesIfU(a, K(1), K(max(rows, cols)+1), V(), fv); };
-  auto fb = [&](auto u, auto v, auto w) { if (fe(K(u), K(v), K(w))) addEdgeOmpU(a, K(u), K(v), E(w)); };
-  readMtxDoOmp(s, weighted, fh, fb);
+  size_t n = 0;
+  auto fh = [&](auto symmetric, auto rows, auto cols, auto size) { n = max(rows, cols); addVerticesIfU(a, K(1), K(n+1), V(), fv); };
+  auto fb = [&](auto u, auto v, auto w) { if (u<=n && v<=n && fe(K(u), K(v), K(w))) addEdgeOmpU(a, K(u), K(v), E(w)); };
+  readMtxDoOmp(s, weighted, fh, fb, block);
   updateOmpU(a);
 }
 template <class G, class FV, class FE>
-inline void readMtxIfOmpW(G &a, const char *pth, bool weighted, FV fv, FE fe) {
+inline void readMtxIfOmpW(G &a, const char *pth, bool weighted, FV fv, FE fe, size_t block=READ_BLOCK_LINES) {
   ifstream s(pth);
-  readMtxIfOmpW(a, s, weighted, fv, fe);
+  readMtxIfOmpW(a, s, weighted, fv, fe, block);
+}
+#endif
+
+
+/**
+ * Read MTX file as graph if test passes, by mapping it to memory.
+ * @param a output graph (updated)
+ * @param pth file path
+ * @param weighted is it weighted?
+ * @param fv include vertex? (u, d)
+ * @param fe include edge? (u, v, w)
+ * @param reserve count degrees first, to reserve exact space for edges?
+ */
+template <class G, class FV, class FE>
+inline void readMtxIfMmapW(G &a, const char *pth, bool weighted, FV fv, FE fe, bool reserve=false) {
+  using K = typename G::key_type;
+  using V = typename G::vertex_value_type;
+  using E = typename G::edge_value_type;
+  vector<K> degrees, inDegrees;
+  if (reserve) readMtxDegreesW(degrees, inDegrees, pth);
+  auto fh = [&](auto symmetric, auto rows, auto cols, auto size) {
+    addVerticesIfU(a, K(1), K(max(rows, cols)+1), V(), fv);
+    if (!reserve) return;
+    reserveEdgesU(a, degrees, inDegrees);
+    degrees.clear();   degrees.shrink_to_fit();
+    inDegrees.clear(); inDegrees.shrink_to_fit();
+  };
+  auto fb = [&](auto u, auto v, auto w) { if (fe(K(u), K(v), K(w))) a.addEdge(K(u), K(v), E(w)); };
+  readMtxDoMmap(pth, weighted, fh, fb);
+  a.update();
+}
+
+
+#ifdef OPENMP
+/**
+ * Read MTX file as graph if test passes, by mapping it to memory.
+ * @param a output graph (updated)
+ * @param pth file path
+ * @param weighted is it weighted?
+ * @param fv include vertex? (u, d)
+ * @param fe include edge? (u, v, w)
+ * @param reserve count degrees first, to reserve exact space for edges?
+ * @note Entries beyond the dimensions in the header are skipped, as the graph
+ * cannot grow while edges are added in parallel.
+ */
+template <class G, class FV, class FE>
+inline void readMtxIfMmapOmpW(G &a, const char *pth, bool weighted, FV fv, FE fe, bool reserve=false) {
+  using K = typename G::key_type;
+  using V = typename G::vertex_value_type;
+  using E = typename G::edge_value_type;
+  vector<K> degrees, inDegrees;
+  size_t n = 0;
+  if (reserve) readMtxDegreesOmpW(degrees, inDegrees, pth);
+  auto fh = [&](auto symmetric, auto rows, auto cols, auto size) {
+    n = max(rows, cols);
+    addVerticesIfU(a, K(1), K(n+1), V(), fv);
+    if (!reserve) return;
+    reserveEdgesOmpU(a, degrees, inDegrees);
+    degrees.clear();   degrees.shrink_to_fit();
+    inDegrees.clear(); inDegrees.shrink_to_fit();
+  };
+  auto fb = [&](auto u, auto v, auto w) { if (u<=n && v<=n && fe(K(u), K(v), K(w))) addEdgeOmpU(a, K(u), K(v), E(w)); };
+  readMtxDoMmapOmp(pth, weighted, fh, fb);
+  updateOmpU(a);
 }
 #endif
 #pragma endregion
@@ -279,17 +482,187 @@ inline void readMtxW(G& a, const char *pth, bool weighted=false) {
  * @param a output graph (updated)
  * @param s input stream
  * @param weighted is it weighted?
+ * @param block number of lines to read at a time
  */
 template <class G>
-inline void readMtxOmpW(G& a, istream& s, bool weighted=false) {
+inline void readMtxOmpW(G& a, istream& s, bool weighted=false, size_t block=READ_BLOCK_LINES) {
   auto fv = [](auto u, auto d)         { return true; };
   auto fe = [](auto u, auto v, auto w) { return true; };
-  readMtxIfOmpW(a, s, weighted, fv, fe);
+  readMtxIfOmpW(a, s, weighted, fv, fe, block);
 }
 template <class G>
-inline void readMtxOmpW(G& a, const char *pth, bool weighted=false) {
+inline void readMtxOmpW(G& a, const char *pth, bool weighted=false, size_t block=READ_BLOCK_LINES) {
   ifstream s(pth);
-  readMtxOmpW(a, s, weighted);
+  readMtxOmpW(a, s, weighted, block);
+}
+#endif
+
+
+/**
+ * Read MTX file as graph, by mapping it to memory.
+ * @param a output graph (updated)
+ * @param pth file path
+ * @param weighted is it weighted?
+ * @param reserve count degrees first, to reserve exact space for edges?
+ */
+template <class G>
+inline void readMtxMmapW(G& a, const char *pth, bool weighted=false, bool reserve=false) {
+  auto fv = [](auto u, auto d)         { return true; };
+  auto fe = [](auto u, auto v, auto w) { return true; };
+  readMtxIfMmapW(a, pth, weighted, fv, fe, reserve);
+}
+
+
+#ifdef OPENMP
+/**
+ * Read MTX file as graph, by mapping it to memory.
+ * @param a output graph (updated)
+ * @param pth file path
+ * @param weighted is it weighted?
+ * @param reserve count degrees first, to reserve exact space for edges?
+ */
+template <class G>
+inline void readMtxMmapOmpW(G& a, const char *pth, bool weighted=false, bool reserve=false) {
+  auto fv = [](auto u, auto d)         { return true; };
+  auto fe = [](auto u, auto v, auto w) { return true; };
+  readMtxIfMmapOmpW(a, pth, weighted, fv, fe, reserve);
+}
+#endif
+#pragma endregion
+
+
+
+
+#pragma region READ MTX CSR
+/**
+ * Read MTX file as a CSR graph, by mapping it to memory.
+ * @param a output graph (updated)
+ * @param pth file path
+ * @param weighted is it weighted?
+ * @throws runtime_error if the header is not a valid coordinate MTX header
+ * @note Vertex ids are 1-based, as with other readers, so vertex 0 has no edges.
+ * Entries beyond the dimensions in the header are skipped.
+ */
+template <class G>
+inline void readMtxCsrW(G& a, const char *pth, bool weighted=false) {
+  MappedFile file(pth);
+  file.adviseSequential();
+  string_view data = file.view();
+  bool symmetric; size_t rows, cols, size;
+  size_t b = readMtxHeader(data, symmetric, rows, cols, size);
+  if (rows==0 && cols==0) throw runtime_error(string("Invalid MTX header: ") + pth);
+  a.respan(max(rows, cols) + 1);
+  readEdgelistBodyCsrW(a, data.data() + b, data.data() + data.size(), weighted, symmetric, 0);
+}
+
+
+#ifdef OPENMP
+/**
+ * Read MTX file as a CSR graph in parallel, by mapping it to memory.
+ * @param a output graph (updated)
+ * @param pth file path
+ * @param weighted is it weighted?
+ * @throws runtime_error if the header is not a valid coordinate MTX header
+ * @note Vertex ids are 1-based, as with other readers, so vertex 0 has no edges.
+ * Entries beyond the dimensions in the header are skipped.
+ */
+template <class G>
+inline void readMtxCsrOmpW(G& a, const char *pth, bool weighted=false) {
+  MappedFile file(pth);
+  file.adviseSequential();
+  string_view data = file.view();
+  bool symmetric; size_t rows, cols, size;
+  size_t b = readMtxHeader(data, symmetric, rows, cols, size);
+  if (rows==0 && cols==0) throw runtime_error(string("Invalid MTX header: ") + pth);
+  a.respan(max(rows, cols) + 1);
+  readEdgelistBodyCsrOmpW(a, data.data() + b, data.data() + data.size(), weighted, symmetric, 0);
+}
+#endif
+#pragma endregion
+
+
+
+
+#pragma region WRITE MTX
+/**
+ * Get the MTX field of an edge weight type.
+ * @tparam E edge weight type
+ * @param weighted are edge weights written?
+ * @returns "pattern", "integer", or "real"
+ */
+template <class E>
+inline const char* mtxField(bool weighted) {
+  if (!weighted || is_same_v<E, None>) return "pattern";
+  return is_integral_v<E>? "integer" : "real";
+}
+
+
+/**
+ * Write the header of an MTX file.
+ * @param a output stream
+ * @param symmetric is it symmetric? (only lower triangle is written)
+ * @param field field of values (pattern, integer, real)
+ * @param rows number of rows
+ * @param cols number of columns
+ * @param size number of entries written
+ */
+inline void writeMtxHeader(ostream& a, bool symmetric, const char *field, size_t rows, size_t cols, size_t size) {
+  a << "%%MatrixMarket matrix coordinate " << field << (symmetric? " symmetric" : " general") << "\n";
+  a << rows << " " << cols << " " << size << "\n";
+}
+
+
+/**
+ * Write a graph as an MTX file.
+ * @param a output stream
+ * @param x graph
+ * @param weighted write edge weights?
+ * @note If the graph is symmetric, only its lower triangle (v <= u) is
+ * written, with a symmetric header. Vertex ids are 1-based, so there are
+ * span-1 rows and columns. The file reads back with readMtx*W().
+ */
+template <class G>
+inline void writeMtx(ostream& a, const G& x, bool weighted=true) {
+  using E = typename G::edge_value_type;
+  bool symmetric = isSymmetric(x);
+  size_t N = x.span()? x.span()-1 : 0, M = 0;
+  auto fe = [&](auto u, auto v, auto w) { return !symmetric || v<=u; };
+  if (!symmetric) M = x.size();
+  else x.forEachVertexKey([&](auto u) {
+    x.forEachEdge(u, [&](auto v, auto w) { if (v<=u) ++M; });
+  });
+  writeMtxHeader(a, symmetric, mtxField<E>(weighted), N, N, M);
+  writeEdgelistIf(a, x, weighted && !is_same_v<E, None>, fe);
+}
+
+
+#ifdef OPENMP
+/**
+ * Write a graph as an MTX file, formatting edges in parallel.
+ * @param a output stream
+ * @param x graph
+ * @param weighted write edge weights?
+ * @note If the graph is symmetric, only its lower triangle (v <= u) is
+ * written, with a symmetric header. Vertex ids are 1-based, so there are
+ * span-1 rows and columns. The file reads back with readMtx*OmpW().
+ */
+template <class G>
+inline void writeMtxOmp(ostream& a, const G& x, bool weighted=true) {
+  using K = typename G::key_type;
+  using E = typename G::edge_value_type;
+  bool symmetric = isSymmetricOmp(x);
+  size_t N = x.span()? x.span()-1 : 0, M = 0;
+  auto fe = [&](auto u, auto v, auto w) { return !symmetric || v<=u; };
+  if (!symmetric) M = x.size();
+  else {
+    #pragma omp parallel for schedule(dynamic, 2048) reduction(+:M)
+    for (size_t u=0; u<=N; ++u) {
+      if (!x.hasVertex(K(u))) continue;
+      x.forEachEdge(K(u), [&](auto v, auto w) { if (v<=K(u)) ++M; });
+    }
+  }
+  writeMtxHeader(a, symmetric, mtxField<E>(weighted), N, N, M);
+  writeEdgelistIfOmp(a, x, weighted && !is_same_v<E, None>, fe);
 }
 #endif
 #pragma endregion
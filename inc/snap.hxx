@@ -2,13 +2,12 @@
 #include <utility>
 #include <string>
 #include <istream>
-#include <sstream>
 #include <fstream>
 #include <algorithm>
-#include <cstdlib>
 #include "_main.hxx"
 #include "Graph.hxx"
 #include "update.hxx"
+#include "edgelist.hxx"
 #ifdef OPENMP
 #include <omp.h>
 #endif
@@ -16,10 +15,10 @@
 using std::tuple;
 using std::string;
 using std::istream;
-using std::istringstream;
 using std::ifstream;
 using std::ofstream;
 using std::move;
+using std::min;
 using std::max;
 using std::getline;
 
@@ -27,6 +26,63 @@ using std::getline;
 
 
 #pragma region METHODS
+#pragma region READ SNAP TEMPORAL LINE
+/**
+ * Read a line (u, v, [t]) of SNAP Temporal file.
+ * @param line input line
+ * @param u source vertex (updated)
+ * @param v target vertex (updated)
+ * @param t timestamp, or 0 if absent (updated)
+ * @returns was an edge read?
+ */
+inline bool readTemporalLine(const string& line, size_t& u, size_t& v, size_t& t) {
+  const char *ib = line.data(), *ie = ib + line.size();
+  const char *iu = findNextNonBlank(ib, ie);
+  const char *ju = readUintW(u, iu, ie);
+  if (ju==iu) return false;
+  const char *iv = findNextNonBlank(ju, ie);
+  const char *jv = readUintW(v, iv, ie);
+  if (jv==iv) return false;
+  readUintW(t, findNextNonBlank(jv, ie), ie);
+  return true;
+}
+#pragma endregion
+
+
+
+
+#pragma region READ SNAP TEMPORAL ORDER
+/**
+ * Read order of graph in SNAP Temporal file, in its first few edges.
+ * @param s input stream
+ * @param size number of edges to read
+ * @param zeroBased does it use 0-based vertex ids? (updated; set if any edge read has vertex id 0)
+ * @returns number of vertices in the edges read, after shifting 0-based ids (0 if none)
+ * @note Lines that are not edges (such as # comments) are skipped, and not counted.
+ * Vertex ids are 1-based in a graph, so 0-based ids must be shifted by 1.
+ */
+inline size_t readTemporalOrder(istream& s, size_t size, bool& zeroBased) {
+  size_t lo = size_t(-1), hi = 0, n = 0;
+  string line;
+  while (size>0 && getline(s, line)) {
+    size_t u, v, t;
+    if (!readTemporalLine(line, u, v, t)) continue;
+    lo = min(lo, min(u, v));
+    hi = max(hi, max(u, v));
+    --size; ++n;
+  }
+  zeroBased = zeroBased || (n>0 && lo==0);
+  return n>0? hi + (zeroBased? 1 : 0) : 0;
+}
+inline size_t readTemporalOrder(const char *pth, size_t size, bool& zeroBased) {
+  ifstream s(pth);
+  return readTemporalOrder(s, size, zeroBased);
+}
+#pragma endregion
+
+
+
+
 #pragma region READ SNAP TEMPORAL DO
 /**
  * Read contents of SNAP Temporal file.
@@ -34,27 +90,28 @@ using std::getline;
  * @param weighted is it weighted?
  * @param symmetric is it symmetric?
  * @param rows number of rows/vertices
- * @param size number of lines/edges to read
+ * @param size number of edges to read
+ * @param base offset to add to vertex ids
  * @param fb on body line (u, v, w)
+ * @note Lines that are not edges (such as # comments) are skipped, and not counted.
  */
 template <class FB>
-inline void readTemporalDo(istream& s, bool weighted, bool symmetric, size_t rows, size_t size, FB fb) {
+inline void readTemporalDo(istream& s, bool weighted, bool symmetric, size_t rows, size_t size, size_t base, FB fb) {
   if (rows==0 || size==0) return;
   // Process body lines sequentially.
   string line;
-  for (; size>0 && getline(s, line); --size) {
+  while (size>0 && getline(s, line)) {
     size_t u, v; double w = 1;
-    istringstream sline(line);
-    if (!(sline >> u >> v)) break;
-    if (weighted) sline >> w;
-    fb(u, v, w);
-    if (symmetric) fb(v, u, w);
+    if (!readEdgelistLineW(u, v, w, line, weighted)) continue;
+    fb(u+base, v+base, w);
+    if (symmetric) fb(v+base, u+base, w);
+    --size;
   }
 }
 template <class FB>
-inline void readTemporalDo(const char *pth, bool weighted, bool symmetric, size_t rows, size_t size, FB fb) {
+inline void readTemporalDo(const char *pth, bool weighted, bool symmetric, size_t rows, size_t size, size_t base, FB fb) {
   ifstream s(pth);
-  readTemporalDo(s, weighted, symmetric, rows, size, fb);
+  readTemporalDo(s, weighted, symmetric, rows, size, base, fb);
 }
 
 
@@ -65,47 +122,57 @@ inline void readTemporalDo(const char *pth, bool weighted, bool symmetric, size_
  * @param weighted is it weighted?
  * @param symmetric is it symmetric?
  * @param rows number of rows/vertices
- * @param size number of lines/edges to read
+ * @param size number of edges to read
+ * @param base offset to add to vertex ids
  * @param fb on body line (u, v, w)
+ * @param block number of lines to read at a time
+ * @note Each edge is notified only on the threads that own its source or
+ * target vertex (see belongsOmp). The next block of lines is read while the
+ * current one is being processed (see readLinesAsyncDo). Lines that are not
+ * edges (such as # comments) are skipped, and not counted; as many more lines
+ * are then read, so that no line after the last edge is consumed. Edges
+ * beyond the given rows are skipped, as the graph cannot grow while edges are
+ * added in parallel.
  */
 template <class FB>
-inline void readTemporalDoOmp(istream& s, bool weighted, bool symmetric, size_t rows, size_t size, FB fb) {
+inline void readTemporalDoOmp(istream& s, bool weighted, bool symmetric, size_t rows, size_t size, size_t base, FB fb, size_t block=READ_BLOCK_LINES) {
   if (rows==0 || size==0) return;
-  // Process body lines in parallel.
+  // Process body lines in parallel, while reading the next block.
   const int THREADS = omp_get_max_threads();
-  const int LINES   = 131072;
-  vector<string> lines(LINES);
-  vector<tuple<size_t, size_t, double>> edges(LINES);
-  while (size>0) {
-    // Read several lines from the stream.
-    int READ = 0;
-    for (int i=0; size>0 && i<LINES; ++i, ++READ, --size)
-      if (!getline(s, lines[i])) break;
-    if (READ==0) break;
-    // Parse lines using multiple threads.
-    #pragma omp parallel for schedule(dynamic, 1024)
-    for (int i=0; i<READ; ++i) {
-      char *line = (char*) lines[i].c_str();
-      size_t u = strtoull(line, &line, 10);
-      size_t v = strtoull(line, &line, 10);
-      double w = weighted? strtod(line, &line) : 0;
-      edges[i] = {u, v, w? w : 1};
-    }
-    // Notify parsed lines.
-    #pragma omp parallel
-    {
-      for (int i=0; i<READ; ++i) {
-        const auto& [u, v, w] = edges[i];
-        fb(u, v, w);
-        if (symmetric) fb(v, u, w);
+  vector<vector2d<tuple<size_t, size_t, double>>> edges(THREADS, vector2d<tuple<size_t, size_t, double>>(THREADS));
+  // Each pass reads as many lines as there are edges left, as each line has at most one edge.
+  for (size_t n=size; n>0;) {
+    size_t read = 0, m = 0;
+    readLinesAsyncDo(s, n, block, [&](const vector<string>& lines, size_t READ) {
+      read += READ;
+      #pragma omp parallel
+      {
+        // Parse lines using multiple threads, and bucket them by owner thread.
+        clearBucketedEdgesOmpU(edges);
+        int t = omp_get_thread_num();
+        #pragma omp for schedule(dynamic, 1024) reduction(+:m)
+        for (size_t i=0; i<READ; ++i) {
+          size_t u, v; double w = 0;
+          if (!readEdgelistLineW(u, v, w, lines[i], weighted)) continue;
+          ++m;
+          if (u+base>rows || v+base>rows) continue;
+          bucketEdgeOmpU(edges[t], u+base, v+base, w? w : 1);
+        }
+        // Notify parsed lines, to their owner threads only.
+        forEachBucketedEdgeOmp(edges, [&](auto u, auto v, auto w) {
+          fb(u, v, w);
+          if (symmetric) fb(v, u, w);
+        });
       }
-    }
+    });
+    if (read==0) break;
+    n -= m;
   }
 }
 template <class FB>
-inline void readTemporalDoOmp(const char *pth, bool weighted, FB fb) {
+inline void readTemporalDoOmp(const char *pth, bool weighted, bool symmetric, size_t rows, size_t size, size_t base, FB fb, size_t block=READ_BLOCK_LINES) {
   ifstream s(pth);
-  readTemporalDoOmp(s, weighted, fb);
+  readTemporalDoOmp(s, weighted, symmetric, rows, size, base, fb, block);
 }
 #endif
 #pragma endregion
@@ -113,6 +180,37 @@ inline void readTemporalDoOmp(const char *pth, bool weighted, FB fb) {
 
 
 
+#pragma region READ SNAP TEMPORAL BATCH
+/**
+ * Read the next batch of edges from a SNAP Temporal stream, by count and/or time window.
+ * @param s input stream
+ * @param line pending line, carried over between batches (updated)
+ * @param size maximum number of edges in the batch (0 => no limit)
+ * @param window time span of the batch, from its first edge (0 => no limit)
+ * @param base offset to add to vertex ids
+ * @param fb on body line (u, v, t)
+ * @returns number of edges read (0 => end of stream)
+ * @note Only one line is buffered, so the stream is never fully read into memory.
+ */
+template <class FB>
+inline size_t readTemporalBatchDo(istream& s, string& line, size_t size, size_t window, size_t base, FB fb) {
+  size_t n = 0, t0 = 0;
+  for (; size==0 || n<size; line.clear()) {
+    if (line.empty() && !getline(s, line)) break;
+    size_t u, v, t;
+    if (!readTemporalLine(line, u, v, t)) continue;
+    if (n==0) t0 = t;
+    else if (window>0 && t>=t0+window) break;  // Keep line for the next batch.
+    fb(u+base, v+base, t);
+    ++n;
+  }
+  return n;
+}
+#pragma endregion
+
+
+
+
 #pragma region READ SNAP TEMPORAL IF
 /**
  * Read SNAP Temporal file as graph if test passes.
@@ -122,23 +220,24 @@ inline void readTemporalDoOmp(const char *pth, bool weighted, FB fb) {
  * @param symmetric is it symmetric?
  * @param rows number of rows/vertices
  * @param size number of lines/edges to read
+ * @param base offset to add to vertex ids
  * @param fv include vertex? (u, d)
  * @param fe include edge? (u, v, w)
  */
 template <class G, class FV, class FE>
-inline void readTemporalIfW(G &a, istream& s, bool weighted, bool symmetric, size_t rows, size_t size, FV fv, FE fe) {
+inline void readTemporalIfW(G &a, istream& s, bool weighted, bool symmetric, size_t rows, size_t size, size_t base, FV fv, FE fe) {
   using K = typename G::key_type;
   using V = typename G::vertex_value_type;
   using E = typename G::edge_value_type;
   addVerticesIfU(a, K(1), K(rows+1), V(), fv);
   auto fb = [&](auto u, auto v, auto w) { if (fe(K(u), K(v), K(w))) a.addEdge(K(u), K(v), E(w)); };
-  readTemporalDo(s, weighted, symmetric, rows, size, fb);
+  readTemporalDo(s, weighted, symmetric, rows, size, base, fb);
   a.update();
 }
 template <class G, class FV, class FE>
-inline void readTemporalIfW(G &a, const char *pth, bool weighted, bool symmetric, size_t rows, size_t size, FV fv, FE fe) {
+inline void readTemporalIfW(G &a, const char *pth, bool weighted, bool symmetric, size_t rows, size_t size, size_t base, FV fv, FE fe) {
   ifstream s(pth);
-  readTemporalIfW(a, s, weighted, symmetric, rows, size, fv, fe);
+  readTemporalIfW(a, s, weighted, symmetric, rows, size, base, fv, fe);
 }
 
 
@@ -151,23 +250,25 @@ inline void readTemporalIfW(G &a, const char *pth, bool weighted, bool symmetric
  * @param symmetric is it symmetric?
  * @param rows number of rows/vertices
  * @param size number of lines/edges to read
+ * @param base offset to add to vertex ids
  * @param fv include vertex? (u, d)
  * @param fe include edge? (u, v, w)
+ * @param block number of lines to read at a time
  */
 template <class G, class FV, class FE>
-inline void readTemporalIfOmpW(G &a, istream& s, bool weighted, bool symmetric, size_t rows, size_t size, FV fv, FE fe) {
+inline void readTemporalIfOmpW(G &a, istream& s, bool weighted, bool symmetric, size_t rows, size_t size, size_t base, FV fv, FE fe, size_t block=READ_BLOCK_LINES) {
   using K = typename G::key_type;
   using V = typename G::vertex_value_type;
   using E = typename G::edge_value_type;
   addVerticesIfU(a, K(1), K(rows+1), V(), fv);
   auto fb = [&](auto u, auto v, auto w) { if (fe(K(u), K(v), K(w))) addEdgeOmpU(a, K(u), K(v), E(w)); };
-  readTemporalDoOmp(s, weighted, symmetric, rows, size, fb);
+  readTemporalDoOmp(s, weighted, symmetric, rows, size, base, fb, block);
   updateOmpU(a);
 }
 template <class G, class FV, class FE>
-inline void readTemporalIfOmpW(G &a, const char *pth, bool weighted, bool symmetric, size_t rows, size_t size, FV fv, FE fe) {
+inline void readTemporalIfOmpW(G &a, const char *pth, bool weighted, bool symmetric, size_t rows, size_t size, size_t base, FV fv, FE fe, size_t block=READ_BLOCK_LINES) {
   ifstream s(pth);
-  readTemporalIfOmpW(a, s, weighted, symmetric, rows, size, fv, fe);
+  readTemporalIfOmpW(a, s, weighted, symmetric, rows, size, base, fv, fe, block);
 }
 #endif
 #pragma endregion
@@ -184,17 +285,18 @@ inline void readTemporalIfOmpW(G &a, const char *pth, bool weighted, bool symmet
  * @param symmetric is it symmetric?
  * @param rows number of rows/vertices
  * @param size number of lines/edges to read
+ * @param base offset to add to vertex ids
  */
 template <class G>
-inline void readTemporalW(G& a, istream& s, bool weighted, bool symmetric, size_t rows, size_t size) {
+inline void readTemporalW(G& a, istream& s, bool weighted, bool symmetric, size_t rows, size_t size, size_t base) {
   auto fv = [](auto u, auto d)         { return true; };
   auto fe = [](auto u, auto v, auto w) { return true; };
-  readTemporalIfW(a, s, weighted, symmetric, rows, size, fv, fe);
+  readTemporalIfW(a, s, weighted, symmetric, rows, size, base, fv, fe);
 }
 template <class G>
-inline void readTemporalW(G& a, const char *pth, bool weighted, bool symmetric, size_t rows, size_t size) {
+inline void readTemporalW(G& a, const char *pth, bool weighted, bool symmetric, size_t rows, size_t size, size_t base) {
   ifstream s(pth);
-  readTemporalW(a, s, weighted, symmetric, rows, size);
+  readTemporalW(a, s, weighted, symmetric, rows, size, base);
 }
 
 
@@ -207,17 +309,19 @@ inline void readTemporalW(G& a, const char *pth, bool weighted, bool symmetric,
  * @param symmetric is it symmetric?
  * @param rows number of rows/vertices
  * @param size number of lines/edges to read
+ * @param base offset to add to vertex ids
+ * @param block number of lines to read at a time
  */
 template <class G>
-inline void readTemporalOmpW(G& a, istream& s, bool weighted, bool symmetric, size_t rows, size_t size) {
+inline void readTemporalOmpW(G& a, istream& s, bool weighted, bool symmetric, size_t rows, size_t size, size_t base, size_t block=READ_BLOCK_LINES) {
   auto fv = [](auto u, auto d)         { return true; };
   auto fe = [](auto u, auto v, auto w) { return true; };
-  readTemporalIfOmpW(a, s, weighted, symmetric, rows, size, fv, fe);
+  readTemporalIfOmpW(a, s, weighted, symmetric, rows, size, base, fv, fe, block);
 }
 template <class G>
-inline void readTemporalOmpW(G& a, const char *pth, bool weighted, bool symmetric, size_t rows, size_t size) {
+inline void readTemporalOmpW(G& a, const char *pth, bool weighted, bool symmetric, size_t rows, size_t size, size_t base, size_t block=READ_BLOCK_LINES) {
   ifstream s(pth);
-  readTemporalOmpW(a, s, weighted, symmetric, rows, size);
+  readTemporalOmpW(a, s, weighted, symmetric, rows, size, base, block);
 }
 #endif
 #pragma endregion
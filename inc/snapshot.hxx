@@ -0,0 +1,356 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <type_traits>
+#include <ostream>
+#include <sys/stat.h>
+#include "_main.hxx"
+#include "Graph.hxx"
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+using std::pair;
+using std::string_view;
+using std::vector;
+using std::ostream;
+using std::is_same_v;
+
+
+
+
+#pragma region CLASSES
+/**
+ * Header of a binary graph snapshot.
+ * @details The header is followed by these sections, each padded to 8 bytes:
+ * vertex existence flags (span x uint8), and then for outgoing and incoming
+ * edges each, offsets ((span+1) x uint64), edge keys (size x K), and edge
+ * weights (size x E, if weighted). All values are stored in native byte order.
+ * Vertex values are not stored.
+ */
+struct SnapshotHeader {
+  /** Magic bytes, to identify a snapshot. */
+  char magic[8];
+  /** Version of the snapshot format. */
+  uint32_t version;
+  /** Size of a vertex id, in bytes. */
+  uint16_t keyBytes;
+  /** Size of an edge weight, in bytes (0 if unweighted). */
+  uint16_t edgeBytes;
+  /** Span of vertex ids. */
+  uint64_t span;
+  /** Number of vertices. */
+  uint64_t order;
+  /** Number of edges. */
+  uint64_t size;
+  /** Size of the source file, in bytes. */
+  uint64_t sourceBytes;
+  /** Modification time of the source file, in nanoseconds. */
+  uint64_t sourceTime;
+};
+
+/** Magic bytes of a snapshot. */
+#define SNAPSHOT_MAGIC "GRAPHSNP"
+/** Version of the snapshot format. */
+#define SNAPSHOT_VERSION 1
+#pragma endregion
+
+
+
+
+#pragma region METHODS
+#pragma region SNAPSHOT SOURCE
+/**
+ * Get the size and modification time of a snapshot source file.
+ * @param pth path to source file
+ * @param bytes size of the file, in bytes (updated)
+ * @param time modification time of the file, in nanoseconds (updated)
+ * @returns does the file exist?
+ */
+inline bool readSnapshotSource(const char *pth, uint64_t& bytes, uint64_t& time) {
+  struct stat st;
+  if (stat(pth, &st)<0) return false;
+  bytes = uint64_t(st.st_size);
+  time  = uint64_t(st.st_mtim.tv_sec) * 1000000000ULL + uint64_t(st.st_mtim.tv_nsec);
+  return true;
+}
+#pragma endregion
+
+
+
+
+#pragma region SNAPSHOT HEADER
+/**
+ * Get the size of a snapshot section, padded to 8 bytes.
+ * @param bytes size of section, in bytes
+ * @returns padded size
+ */
+inline size_t snapshotPadded(size_t bytes) {
+  return (bytes + 7) & ~size_t(7);
+}
+
+
+/**
+ * Get the expected size of a snapshot file.
+ * @param h snapshot header
+ * @returns size in bytes
+ */
+inline size_t snapshotBytes(const SnapshotHeader& h) {
+  size_t S = h.span, M = h.size;
+  size_t edgesBytes = snapshotPadded((S+1) * sizeof(uint64_t))
+    + snapshotPadded(M * h.keyBytes)
+    + snapshotPadded(M * h.edgeBytes);
+  return sizeof(SnapshotHeader) + snapshotPadded(S) + 2 * edgesBytes;
+}
+
+
+/**
+ * Read the header of a snapshot, and check if it matches the graph type and source.
+ * @tparam K vertex id type
+ * @tparam E edge weight type
+ * @param data snapshot contents
+ * @param h snapshot header (updated)
+ * @param sourceBytes size of the source file, in bytes
+ * @param sourceTime modification time of the source file, in nanoseconds
+ * @returns is the snapshot valid and up-to-date?
+ */
+template <class K, class E>
+inline bool readSnapshotHeader(string_view data, SnapshotHeader& h, uint64_t sourceBytes, uint64_t sourceTime) {
+  constexpr size_t EDGE_BYTES = is_same_v<E, None>? 0 : sizeof(E);
+  if (data.size() < sizeof(SnapshotHeader)) return false;
+  memcpy(&h, data.data(), sizeof(SnapshotHeader));
+  if (memcmp(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic))!=0) return false;
+  if (h.version!=SNAPSHOT_VERSION) return false;
+  if (h.keyBytes!=sizeof(K) || h.edgeBytes!=EDGE_BYTES) return false;
+  if (h.sourceBytes!=sourceBytes || h.sourceTime!=sourceTime) return false;
+  return data.size()==snapshotBytes(h);
+}
+#pragma endregion
+
+
+
+
+#pragma region WRITE SNAPSHOT
+/**
+ * Write a section of a snapshot, padded to 8 bytes.
+ * @param a output stream (updated)
+ * @param data section data
+ * @param bytes size of section, in bytes
+ */
+inline void writeSnapshotSection(ostream& a, const void *data, size_t bytes) {
+  const char zeros[8] = {};
+  a.write((const char*) data, bytes);
+  a.write(zeros, snapshotPadded(bytes) - bytes);
+}
+
+
+/**
+ * Write a binary snapshot of a graph.
+ * @param a output stream (binary, updated)
+ * @param x graph to write
+ * @param sourceBytes size of the source file, in bytes
+ * @param sourceTime modification time of the source file, in nanoseconds
+ * @note Incoming edges are built from the outgoing edges, in order of source
+ * vertex, so that they are already sorted when the snapshot is read.
+ */
+template <class G>
+inline void writeSnapshot(ostream& a, const G& x, uint64_t sourceBytes=0, uint64_t sourceTime=0) {
+  using K = typename G::key_type;
+  using E = typename G::edge_value_type;
+  constexpr bool   WEIGHTED   = !is_same_v<E, None>;
+  constexpr size_t EDGE_BYTES = WEIGHTED? sizeof(E) : 0;
+  size_t S = x.span();
+  size_t M = x.size();
+  // Gather vertex existence flags, and outgoing edges.
+  vector<uint8_t>  exists(S);
+  vector<uint64_t> offsets(S+1);
+  vector<K> keys(M);
+  vector<E> weights(WEIGHTED? M : 0);
+  x.forEachVertexKey([&](auto u) { exists[u] = 1; });
+  uint64_t i = 0;
+  for (size_t u=0; u<S; ++u) {
+    offsets[u] = i;
+    if (!exists[u]) continue;
+    x.forEachEdge(K(u), [&](auto v, auto w) {
+      keys[i] = v;
+      if (WEIGHTED) weights[i] = w;
+      ++i;
+    });
+  }
+  offsets[S] = i;
+  // Build incoming edges.
+  vector<uint64_t> degrees(S+1), roffsets(S+1);
+  vector<K> rkeys(M);
+  vector<E> rweights(WEIGHTED? M : 0);
+  for (size_t j=0; j<M; ++j)
+    ++degrees[keys[j]];
+  exclusiveScanW(roffsets, degrees);
+  fillValueU(degrees, uint64_t());
+  for (size_t u=0; u<S; ++u) {
+    for (uint64_t j=offsets[u]; j<offsets[u+1]; ++j) {
+      K v = keys[j];
+      uint64_t r = roffsets[v] + degrees[v]++;
+      rkeys[r] = K(u);
+      if (WEIGHTED) rweights[r] = weights[j];
+    }
+  }
+  // Write header, and then all sections.
+  SnapshotHeader h;
+  memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic));
+  h.version   = SNAPSHOT_VERSION;
+  h.keyBytes  = sizeof(K);
+  h.edgeBytes = EDGE_BYTES;
+  h.span  = S;
+  h.order = x.order();
+  h.size  = M;
+  h.sourceBytes = sourceBytes;
+  h.sourceTime  = sourceTime;
+  a.write((const char*) &h, sizeof(h));
+  writeSnapshotSection(a, exists.data(),   S);
+  writeSnapshotSection(a, offsets.data(),  (S+1) * sizeof(uint64_t));
+  writeSnapshotSection(a, keys.data(),     M * sizeof(K));
+  writeSnapshotSection(a, weights.data(),  M * EDGE_BYTES);
+  writeSnapshotSection(a, roffsets.data(), (S+1) * sizeof(uint64_t));
+  writeSnapshotSection(a, rkeys.data(),    M * sizeof(K));
+  writeSnapshotSection(a, rweights.data(), M * EDGE_BYTES);
+}
+#pragma endregion
+
+
+
+
+#pragma region READ SNAPSHOT EDGES
+/**
+ * Assign edges of a graph from a section of a snapshot.
+ * @tparam REV incoming edges?
+ * @param a output graph (updated)
+ * @param S span of vertex ids
+ * @param offsets edge offsets of each vertex
+ * @param keys edge keys
+ * @param weights edge weights (if weighted)
+ */
+template <bool REV, class G, class K, class E>
+inline void readSnapshotEdgesW(G& a, size_t S, const uint64_t *offsets, const K *keys, const E *weights) {
+  constexpr bool WEIGHTED = !is_same_v<E, None>;
+  vector<pair<K, E>> edges;
+  for (size_t u=0; u<S; ++u) {
+    edges.clear();
+    for (uint64_t i=offsets[u]; i<offsets[u+1]; ++i)
+      edges.push_back({keys[i], WEIGHTED? weights[i] : E()});
+    if (REV) a.assignInEdges(K(u), edges.begin(), edges.end());
+    else     a.assignEdges  (K(u), edges.begin(), edges.end());
+  }
+}
+
+
+#ifdef OPENMP
+/**
+ * Assign edges of a graph from a section of a snapshot in parallel.
+ * @tparam REV incoming edges?
+ * @param a output graph (updated)
+ * @param S span of vertex ids
+ * @param offsets edge offsets of each vertex
+ * @param keys edge keys
+ * @param weights edge weights (if weighted)
+ */
+template <bool REV, class G, class K, class E>
+inline void readSnapshotEdgesOmpW(G& a, size_t S, const uint64_t *offsets, const K *keys, const E *weights) {
+  constexpr bool WEIGHTED = !is_same_v<E, None>;
+  #pragma omp parallel
+  {
+    vector<pair<K, E>> edges;
+    #pragma omp for schedule(dynamic, 2048)
+    for (size_t u=0; u<S; ++u) {
+      edges.clear();
+      for (uint64_t i=offsets[u]; i<offsets[u+1]; ++i)
+        edges.push_back({keys[i], WEIGHTED? weights[i] : E()});
+      if (REV) a.assignInEdges(K(u), edges.begin(), edges.end());
+      else     a.assignEdges  (K(u), edges.begin(), edges.end());
+    }
+  }
+}
+#endif
+#pragma endregion
+
+
+
+
+#pragma region READ SNAPSHOT
+/**
+ * Read a binary snapshot of a graph, by mapping it to memory.
+ * @param a output graph (updated)
+ * @param pth path to snapshot file
+ * @param sourceBytes size of the source file, in bytes
+ * @param sourceTime modification time of the source file, in nanoseconds
+ * @returns was the snapshot valid and up-to-date? (else graph is unchanged)
+ */
+template <class G>
+inline bool readSnapshotW(G& a, const char *pth, uint64_t sourceBytes, uint64_t sourceTime) {
+  using K = typename G::key_type;
+  using E = typename G::edge_value_type;
+  MappedFile file(pth);
+  file.adviseSequential();
+  SnapshotHeader h;
+  if (!readSnapshotHeader<K, E>(file.view(), h, sourceBytes, sourceTime)) return false;
+  size_t S = h.span, M = h.size;
+  const char     *ptr      = file.data() + sizeof(SnapshotHeader);
+  const uint8_t  *exists   = (const uint8_t*)  ptr; ptr += snapshotPadded(S);
+  const uint64_t *offsets  = (const uint64_t*) ptr; ptr += snapshotPadded((S+1) * sizeof(uint64_t));
+  const K        *keys     = (const K*)        ptr; ptr += snapshotPadded(M * sizeof(K));
+  const E        *weights  = (const E*)        ptr; ptr += snapshotPadded(M * h.edgeBytes);
+  const uint64_t *roffsets = (const uint64_t*) ptr; ptr += snapshotPadded((S+1) * sizeof(uint64_t));
+  const K        *rkeys    = (const K*)        ptr; ptr += snapshotPadded(M * sizeof(K));
+  const E        *rweights = (const E*)        ptr;
+  a.clear();
+  a.respan(S);
+  for (size_t u=0; u<S; ++u)
+    if (exists[u]) a.addVertex(K(u));
+  readSnapshotEdgesW<false>(a, S, offsets,  keys,  weights);
+  if (a.hasInEdges()) readSnapshotEdgesW<true>(a, S, roffsets, rkeys, rweights);
+  a.update();
+  return true;
+}
+
+
+#ifdef OPENMP
+/**
+ * Read a binary snapshot of a graph in parallel, by mapping it to memory.
+ * @param a output graph (updated)
+ * @param pth path to snapshot file
+ * @param sourceBytes size of the source file, in bytes
+ * @param sourceTime modification time of the source file, in nanoseconds
+ * @returns was the snapshot valid and up-to-date? (else graph is unchanged)
+ */
+template <class G>
+inline bool readSnapshotOmpW(G& a, const char *pth, uint64_t sourceBytes, uint64_t sourceTime) {
+  using K = typename G::key_type;
+  using E = typename G::edge_value_type;
+  MappedFile file(pth);
+  file.adviseWillNeed();
+  SnapshotHeader h;
+  if (!readSnapshotHeader<K, E>(file.view(), h, sourceBytes, sourceTime)) return false;
+  size_t S = h.span, M = h.size;
+  const char     *ptr      = file.data() + sizeof(SnapshotHeader);
+  const uint8_t  *exists   = (const uint8_t*)  ptr; ptr += snapshotPadded(S);
+  const uint64_t *offsets  = (const uint64_t*) ptr; ptr += snapshotPadded((S+1) * sizeof(uint64_t));
+  const K        *keys     = (const K*)        ptr; ptr += snapshotPadded(M * sizeof(K));
+  const E        *weights  = (const E*)        ptr; ptr += snapshotPadded(M * h.edgeBytes);
+  const uint64_t *roffsets = (const uint64_t*) ptr; ptr += snapshotPadded((S+1) * sizeof(uint64_t));
+  const K        *rkeys    = (const K*)        ptr; ptr += snapshotPadded(M * sizeof(K));
+  const E        *rweights = (const E*)        ptr;
+  a.clear();
+  a.respan(S);
+  for (size_t u=0; u<S; ++u)
+    if (exists[u]) a.addVertex(K(u));
+  readSnapshotEdgesOmpW<false>(a, S, offsets,  keys,  weights);
+  if (a.hasInEdges()) readSnapshotEdgesOmpW<true>(a, S, roffsets, rkeys, rweights);
+  a.update();
+  return true;
+}
+#endif
+#pragma endregion
+#pragma endregion
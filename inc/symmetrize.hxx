@@ -5,6 +5,46 @@
 
 
 #pragma region METHODS
+/**
+ * Check if a graph is symmetric.
+ * @param x input graph
+ * @returns does every edge (u, v, w) have a reverse edge (v, u, w)?
+ */
+template <class G>
+inline bool isSymmetric(const G& x) {
+  bool a = true;
+  x.forEachVertexKey([&](auto u) {
+    if (!a) return;
+    x.forEachEdge(u, [&](auto v, auto w) {
+      if (!x.hasEdge(v, u) || x.edgeValue(v, u)!=w) a = false;
+    });
+  });
+  return a;
+}
+
+#ifdef OPENMP
+/**
+ * Check if a graph is symmetric in parallel.
+ * @param x input graph
+ * @returns does every edge (u, v, w) have a reverse edge (v, u, w)?
+ */
+template <class G>
+inline bool isSymmetricOmp(const G& x) {
+  using K = typename G::key_type;
+  size_t S = x.span();
+  bool a = true;
+  #pragma omp parallel for schedule(dynamic, 2048) reduction(&&:a)
+  for (size_t u=0; u<S; ++u) {
+    if (!a || !x.hasVertex(K(u))) continue;
+    x.forEachEdge(K(u), [&](auto v, auto w) {
+      if (!x.hasEdge(v, K(u)) || x.edgeValue(v, K(u))!=w) a = false;
+    });
+  }
+  return a;
+}
+#endif
+
+
 /**
  * Obtain the symmetric version of a graph.
  * @param a output symmetric graph (empty, updated)
@@ -1,13 +1,18 @@
 #pragma once
 #include <utility>
+#include <tuple>
 #include <vector>
 #include <cstdint>
+#include <algorithm>
+#include "_main.hxx"
 #ifdef OPENMP
 #include <omp.h>
 #endif
 
 using std::pair;
+using std::tuple;
 using std::vector;
+using std::min;
 
 
 
@@ -47,6 +52,45 @@ inline void addVerticesU(G& a, K u, K U, V d=V()) {
 
 
 
+#pragma region RESERVE EDGES
+/**
+ * Reserve space for the outgoing and incoming edges of each vertex in a graph.
+ * @param a graph to reserve space in
+ * @param degrees out-degree of each vertex
+ * @param inDegrees in-degree of each vertex
+ */
+template <class G, class K>
+inline void reserveEdgesU(G& a, const vector<K>& degrees, const vector<K>& inDegrees) {
+  size_t S = min(a.span(), degrees.size());
+  for (size_t u=0; u<S; ++u) {
+    a.reserveEdges  (K(u), degrees[u]);
+    a.reserveInEdges(K(u), inDegrees[u]);
+  }
+}
+
+
+#ifdef OPENMP
+/**
+ * Reserve space for the outgoing and incoming edges of each vertex in a graph in parallel.
+ * @param a graph to reserve space in
+ * @param degrees out-degree of each vertex
+ * @param inDegrees in-degree of each vertex
+ */
+template <class G, class K>
+inline void reserveEdgesOmpU(G& a, const vector<K>& degrees, const vector<K>& inDegrees) {
+  size_t S = min(a.span(), degrees.size());
+  #pragma omp parallel for schedule(dynamic, 2048)
+  for (size_t u=0; u<S; ++u) {
+    a.reserveEdges  (K(u), degrees[u]);
+    a.reserveInEdges(K(u), inDegrees[u]);
+  }
+}
+#endif
+#pragma endregion
+
+
+
+
 #pragma region ADD EDGE
 /**
  * Add an edge to a graph.
@@ -80,6 +124,60 @@ inline void addEdgeOmpU(G& a, K u, K v, E w=E()) {
 
 
 
+#pragma region BUCKET EDGES
+#ifdef OPENMP
+/**
+ * Bucket an edge for the threads that own its source and target vertices.
+ * @param buckets edge buckets of current thread, indexed by owner thread (updated)
+ * @param u source vertex
+ * @param v destination vertex
+ * @param w edge weight
+ * @note An edge is needed by the owner of u (out-edges), and the owner of v
+ * (in-edges), see addEdgeOmpU(). It is bucketed once if both are the same.
+ */
+template <class K, class E>
+inline void bucketEdgeOmpU(vector2d<tuple<K, K, E>>& buckets, K u, K v, E w) {
+  int T  = omp_get_num_threads();
+  int tu = ownerOmp(u, T);
+  int tv = ownerOmp(v, T);
+  buckets[tu].push_back({u, v, w});
+  if (tv!=tu) buckets[tv].push_back({u, v, w});
+}
+
+
+/**
+ * Iterate over the edges bucketed by all threads for the current thread.
+ * @param buckets edge buckets of each thread, indexed by owner thread
+ * @param fp process function (u, v, w)
+ * @note Must be called in the same parallel team that filled the buckets,
+ * after a barrier.
+ */
+template <class K, class E, class FP>
+inline void forEachBucketedEdgeOmp(const vector<vector2d<tuple<K, K, E>>>& buckets, FP fp) {
+  int t = omp_get_thread_num();
+  for (const auto& bs : buckets) {
+    for (const auto& [u, v, w] : bs[t])
+      fp(u, v, w);
+  }
+}
+
+
+/**
+ * Clear the edge buckets of the current thread.
+ * @param buckets edge buckets of each thread, indexed by owner thread (updated)
+ */
+template <class K, class E>
+inline void clearBucketedEdgesOmpU(vector<vector2d<tuple<K, K, E>>>& buckets) {
+  int t = omp_get_thread_num();
+  for (auto& b : buckets[t])
+    b.clear();
+}
+#endif
+#pragma endregion
+
+
+
+
 #pragma region REMOVE EDGE
 /**
  * Remove an edge from a graph.
@@ -125,28 +223,23 @@ inline void updateU(G& a) {
 /**
  * Update changes made to a graph in parallel.
  * @param a graph to update
+ * @note Only vertices changed since the last update are visited, in a
+ * single pass that finalizes both out- and in-edges. Scratch buffers are
+ * kept by the graph, for each thread.
  */
 template <class G>
 inline void updateOmpU(G& a) {
-  using  K = typename G::key_type;
-  using  E = typename G::edge_value_type;
-  size_t S = a.span();
-  // Create per-thread buffers for update operation.
-  int THREADS = omp_get_max_threads();
-  vector<vector<pair<K, E>>*> bufs(THREADS);
-  for (int i=0; i<THREADS; ++i)
-    bufs[i] = new vector<pair<K, E>>();
-  // Update edges of each vertex individually.
-  #pragma omp parallel for schedule(dynamic, 2048)
-  for (K u=0; u<S; ++u) {
-    int t = omp_get_thread_num();
-    a.updateEdges(u, bufs[t]);
+  // Update out- and in-edges of each vertex changed since the last update, and find the change in total edges.
+  ssize_t dm = 0;
+  #pragma omp parallel reduction(+:dm)
+  {
+    for (const auto& d : a.pendingVertices()) {
+      #pragma omp for schedule(dynamic, 2048) nowait
+      for (size_t i=0; i<d.size(); ++i)
+        dm += a.updatePendingVertex(d[i].first, d[i].second);
+    }
   }
-  // Update the entire graph, find total vertices and edges.
-  a.update();
-  // Clean up.
-  for (int i=0; i<THREADS; ++i)
-    delete bufs[i];
+  a.finishPendingUpdate(dm);
 }
 #endif
 #pragma endregion
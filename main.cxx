@@ -1,6 +1,12 @@
 #include <cstdint>
 #include <cstdlib>
 #include <cstdio>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <exception>
+#include <csignal>
+#include <unistd.h>
 #include "inc/main.hxx"
 #include "options.hxx"
 
@@ -24,39 +30,121 @@ void checkInputFile(const string& inputGraph) {
   }
 }
 
+/**
+* @brief Handle the input shards (parts of one graph) for reading the graph.
+* @param inputFormat The input format (edgelist only).
+* @param graph The graph object to be populated.
+* @param inputShards The paths to the input shard files.
+* @returns total size of the shards, in bytes.
+* @throws runtime_error if the input format does not support shards.
+*/
+template <class G>
+size_t handleInputShards(const string& inputFormat, G& graph, const vector<string>& inputShards) {
+  if (inputFormat != "edgelist") throw runtime_error("Sharded input is only supported for edgelist, not: " + inputFormat);
+  size_t S = inputShards.size(), total = 0;
+  auto fp = [&](size_t i, size_t edges, size_t bytes, double seconds) {
+    total += bytes;
+    printf("Read shard %zu/%zu %s: %zu edges, %.1f MB, %.3f seconds (%.1f MB/s)\n",
+      i+1, S, inputShards[i].c_str(), edges, bytes / 1e6, seconds, seconds > 0 ? bytes / 1e6 / seconds : 0.0);
+    fflush(stdout);
+  };
+  #ifdef OPENMP
+  readEdgelistShardsOmpW(graph, inputShards, fp);
+  #else
+  readEdgelistShardsW(graph, inputShards, fp);
+  #endif
+  return total;
+}
+
 /**
 * @brief Handle the input format for reading the graph.
-* @param inputFormat The input format (edgelist, matrix-market, snap-temporal).
+* @param inputFormat The input format (edgelist, matrix-market, snap-temporal, ligra, gap).
 * @param graph The graph object to be populated.
 * @param inputGraph The path to the input graph file.
+* @param temporalStream The stream to read further temporal edges from (snap-temporal only).
+* @param temporalBase The number of temporal edges to load as the base graph (snap-temporal only).
+* @param temporalZeroBased Are temporal vertex ids 0-based, and shifted by 1? (updated; set if the base graph has vertex 0, snap-temporal only)
+* @param readBlock The number of lines to read at a time from a stream (snap-temporal only).
 * @throws runtime_error if the input format is unknown.
 */
 #ifdef OPENMP
-void handleInputFormat(const string& inputFormat, DiGraph<int, int, int>& graph, const string& inputGraph) {
+template <class G>
+void handleInputFormat(const string& inputFormat, G& graph, const string& inputGraph, ifstream& temporalStream, size_t temporalBase, bool& temporalZeroBased, size_t readBlock=READ_BLOCK_LINES) {
   if (inputFormat == "matrix-market") {
-    readMtxOmpW(graph, inputGraph.c_str());
+    readMtxMmapOmpW(graph, inputGraph.c_str(), false, true);
   } else if (inputFormat == "edgelist") {
-    // handle edgelist format
+    readEdgelistMmapOmpW(graph, inputGraph.c_str(), true);
+  } else if (inputFormat == "ligra") {
+    readLigraOmpW(graph, inputGraph.c_str());
+  } else if (inputFormat == "gap") {
+    readGapOmpW(graph, inputGraph.c_str(), isGapWeighted(inputGraph));
   } else if (inputFormat == "snap-temporal"){
-    // handle snap-temporal format
+    size_t rows = readTemporalOrder(inputGraph.c_str(), temporalBase, temporalZeroBased);
+    temporalStream.open(inputGraph);
+    readTemporalOmpW(graph, temporalStream, false, false, rows, temporalBase, temporalZeroBased? 1 : 0, readBlock);
   } else {
     throw runtime_error("Unknown input format: " + inputFormat);
   }
 }
 #else
-void handleInputFormat(const string& inputFormat, DiGraph<int, int, int>& graph, const string& inputGraph) {
+template <class G>
+void handleInputFormat(const string& inputFormat, G& graph, const string& inputGraph, ifstream& temporalStream, size_t temporalBase, bool& temporalZeroBased, size_t readBlock=READ_BLOCK_LINES) {
   if (inputFormat == "matrix-market") {
-    readMtxW(graph, inputGraph.c_str());
+    readMtxMmapW(graph, inputGraph.c_str(), false, true);
   } else if (inputFormat == "edgelist") {
-    // handle edgelist format
+    readEdgelistMmapW(graph, inputGraph.c_str(), true);
+  } else if (inputFormat == "ligra") {
+    readLigraW(graph, inputGraph.c_str());
+  } else if (inputFormat == "gap") {
+    readGapW(graph, inputGraph.c_str(), isGapWeighted(inputGraph));
   } else if (inputFormat == "snap-temporal"){
-    // handle snap-temporal format
+    size_t rows = readTemporalOrder(inputGraph.c_str(), temporalBase, temporalZeroBased);
+    temporalStream.open(inputGraph);
+    readTemporalW(graph, temporalStream, false, false, rows, temporalBase, temporalZeroBased? 1 : 0);
   } else {
     throw runtime_error("Unknown input format: " + inputFormat);
   }
 }
 #endif
 
+/**
+* @brief Load the input graph from a binary snapshot in the cache directory, or read it and save its snapshot.
+* @param cacheDir The directory to keep graph snapshots in.
+* @param inputFormat The input format (edgelist, matrix-market).
+* @param graph The graph object to be populated.
+* @param inputGraph The path to the input graph file.
+* @returns true if the graph was loaded from a snapshot.
+* @note A snapshot is reused only if the size and modification time of the input graph file are unchanged.
+*/
+template <class G>
+bool handleInputCache(const string& cacheDir, const string& inputFormat, G& graph, const string& inputGraph) {
+  uint64_t sourceBytes = 0, sourceTime = 0;
+  readSnapshotSource(inputGraph.c_str(), sourceBytes, sourceTime);
+  string name = inputGraph.substr(inputGraph.find_last_of('/') + 1);
+  char hash[20]; snprintf(hash, sizeof(hash), "%016zx", std::hash<string>{}(inputGraph));
+  string cacheFile = cacheDir + "/" + name + "." + hash + "." + inputFormat + ".snapshot";
+  ifstream cached(cacheFile);
+  if (cached) {
+    cached.close();
+    #ifdef OPENMP
+    if (readSnapshotOmpW(graph, cacheFile.c_str(), sourceBytes, sourceTime)) return true;
+    #else
+    if (readSnapshotW(graph, cacheFile.c_str(), sourceBytes, sourceTime)) return true;
+    #endif
+  }
+  ifstream temporalStream;
+  bool temporalZeroBased = false;
+  handleInputFormat(inputFormat, graph, inputGraph, temporalStream, 0, temporalZeroBased);
+  // Write to a temporary file first, so that a partial snapshot is never read.
+  string tempFile = cacheFile + ".tmp";
+  ofstream out(tempFile, std::ios::binary);
+  if (!out) throw runtime_error("Cannot write to cache directory: " + cacheDir);
+  writeSnapshot(out, graph, sourceBytes, sourceTime);
+  out.close();
+  if (!out || rename(tempFile.c_str(), cacheFile.c_str())!=0) throw runtime_error("Failed to write snapshot: " + cacheFile);
+  return false;
+}
+
 /**
 * @brief Handle the input transformation (transpose,unsymmetrize,symmetrize,loop-deadends,loop-vertices,clear-weights,set-weights) for the graph.
 * @param inputTransform The input transformation to apply.
@@ -65,7 +153,8 @@ void handleInputFormat(const string& inputFormat, DiGraph<int, int, int>& graph,
 */
 
 #ifdef OPENMP
-void handleInputTransform(const string& inputTransform, DiGraph<int, int, int>& graph) {
+template <class G>
+void handleInputTransform(const string& inputTransform, G& graph) {
   if (inputTransform == "");
   else if (inputTransform == "transpose") {
     graph = transposeOmp(graph);
@@ -86,7 +175,8 @@ void handleInputTransform(const string& inputTransform, DiGraph<int, int, int>&
   }
 }
 #else
-void handleInputTransform(const string& inputTransform, DiGraph<int, int, int>& graph) {
+template <class G>
+void handleInputTransform(const string& inputTransform, G& graph) {
   if (inputTransform == "");
   else if (inputTransform == "transpose") {
     graph = transpose(graph);
@@ -114,45 +204,423 @@ void handleInputTransform(const string& inputTransform, DiGraph<int, int, int>&
 * @param outputPrefix The prefix for the output file name.
 * @param counter The counter value for the output file name.
 * @param outputFile The ofstream object for the output file.
+* @param suffix The suffix (extension) for the output file name.
+* @throws runtime_error if the output file cannot be created.
+*/
+void createOutputFile(const string& outputDir, const string& outputPrefix, int& counter, ofstream& outputFile, const string& suffix="") {
+  string outputFileName = outputDir + outputPrefix + "_" + to_string(counter) + suffix;
+  outputFile.open(outputFileName, std::ios::out | std::ios::binary);
+  if (!outputFile) {
+    throw runtime_error("Failed to create file: " + outputFileName);
+  }
+}
+
+/**
+* @brief Create the output file for a sequence of batch updates.
+* @param outputDir The directory path for the output file.
+* @param outputPrefix The prefix for the output file name.
+* @param outputFile The ofstream object for the output file.
 * @throws runtime_error if the output file cannot be created.
 */
-void createOutputFile(const string& outputDir, const string& outputPrefix, int& counter, ofstream& outputFile) {
-  string outputFileName = outputDir + outputPrefix + "_" + to_string(counter);
-  outputFile.open(outputFileName);
+void createSequenceFile(const string& outputDir, const string& outputPrefix, ofstream& outputFile) {
+  string outputFileName = outputDir + outputPrefix + ".seq";
+  outputFile.open(outputFileName, std::ios::out | std::ios::binary);
   if (!outputFile) {
     throw runtime_error("Failed to create file: " + outputFileName);
   }
 }
 
 /**
- * Write a graph in the edge list format to an output file.
- * @tparam K The vertex ID type.
- * @tparam V The vertex data type.
- * @tparam E The edge weight type.
- * @param outputFile The output file stream.
+* @brief Open the streaming output for batch updates, instead of numbered files.
+* @param output The path to stream to, such as a named pipe ("-" for stdout).
+* @param outputStream The ofstream object for the stream.
+* @throws runtime_error if the stream cannot be opened.
+* @note For stdout, the updates get their own descriptor, and stdout is then
+* redirected to stderr, so that progress messages do not mix with the updates.
+* Opening a named pipe waits for a consumer, and writes block while it is full.
+*/
+void createOutputStream(const string& output, ofstream& outputStream) {
+  string path = output;
+  if (output == "-") {
+    fflush(stdout);
+    cout.flush();
+    int fd = dup(STDOUT_FILENO);
+    if (fd < 0 || dup2(STDERR_FILENO, STDOUT_FILENO) < 0) throw runtime_error("Failed to redirect stdout");
+    path = "/dev/fd/" + to_string(fd);
+  }
+  // Fail on a closed consumer, instead of being killed.
+  signal(SIGPIPE, SIG_IGN);
+  outputStream.open(path, std::ios::out | std::ios::binary);
+  if (!outputStream) throw runtime_error("Failed to open output stream: " + output);
+}
+
+/**
+ * Write a graph in the edge list format to an output stream.
+ * @tparam G The graph type.
+ * @param outputFile The output stream (file, or in-memory snapshot).
  * @param graph The directed graph to write.
  * @param weighted A flag indicating whether to print edge weights.
  */
-template <class K, class V, class E>
-inline void writeEdgeList(ofstream& outputFile, const DiGraph<K, V, E>& graph, bool weighted=true) {
+template <class G>
+inline void writeEdgeList(ostream& outputFile, const G& graph, bool weighted=true) {
   outputFile << graph.order() << " " << graph.size() << "\n";
-  graph.forEachVertex([&](K u, V d) {
-    graph.forEachEdge(u, [&](K v, E w) {
-      outputFile << to_string(u) << " " << to_string(v);
-      if (weighted) outputFile << " " << to_string(w);
-      outputFile << "\n";
-    });
-  });
+  #ifdef OPENMP
+  writeEdgelistOmp(outputFile, graph, weighted);
+  #else
+  writeEdgelist(outputFile, graph, weighted);
+  #endif
+}
+
+/**
+* @brief Check if an output format is known.
+* @param outputFormat The output format (edgelist, matrix-market, ligra, ligra-weighted, gap, gap-weighted, delta, matrix-market-delta, binary, sequence).
+* @throws runtime_error if the output format is unknown.
+*/
+void checkOutputFormat(const string& outputFormat) {
+  if (outputFormat != "edgelist" && outputFormat != "matrix-market" && outputFormat != "ligra" && outputFormat != "ligra-weighted" && outputFormat != "gap" && outputFormat != "gap-weighted" && outputFormat != "delta" && outputFormat != "matrix-market-delta" && outputFormat != "binary" && outputFormat != "sequence") {
+    throw runtime_error("Unknown output format: " + outputFormat);
+  }
+}
+
+/**
+* @brief Check if an output format is one of the Matrix Market formats.
+* @param outputFormat The output format.
+* @returns true for matrix-market and matrix-market-delta.
+*/
+bool isMtxOutput(const string& outputFormat) {
+  return outputFormat == "matrix-market" || outputFormat == "matrix-market-delta";
+}
+
+/**
+* @brief Check if an output format writes the whole updated graph after each batch.
+* @param outputFormat The output format.
+* @returns true for edgelist, matrix-market, ligra, ligra-weighted, gap and gap-weighted.
+*/
+bool isSnapshotOutput(const string& outputFormat) {
+  return outputFormat == "edgelist" || outputFormat == "matrix-market" || outputFormat == "ligra" || outputFormat == "ligra-weighted" || outputFormat == "gap" || outputFormat == "gap-weighted";
+}
+
+/**
+* @brief Get the file extension of the graphs written in an output format.
+* @param outputFormat The output format.
+* @returns .mtx for the Matrix Market formats, .adj for ligra, .sg for gap, .wsg for gap-weighted, or none.
+*/
+string outputSuffix(const string& outputFormat) {
+  if (isMtxOutput(outputFormat)) return ".mtx";
+  if (outputFormat == "ligra" || outputFormat == "ligra-weighted") return ".adj";
+  if (outputFormat == "gap") return ".sg";
+  if (outputFormat == "gap-weighted") return ".wsg";
+  return "";
+}
+
+/**
+* @brief Write the graph to an output stream.
+* @param output The output stream (file, or in-memory snapshot).
+* @param graph The graph object to be written.
+* @param outputFormat The output format; the Matrix Market, Ligra, and GAP formats are written as such, and all others as edgelist.
+* @note Ligra and GAP graphs have 0-based vertex ids, and vertices are renumbered to leave no gaps.
+*/
+template <class G>
+void writeOutputGraph(ostream& output, const G& graph, const string& outputFormat="edgelist") {
+  if (isMtxOutput(outputFormat)) writeMtxOmp(output, graph);
+  else if (outputFormat == "ligra" || outputFormat == "ligra-weighted") writeLigraOmp(output, graph, outputFormat == "ligra-weighted");
+  else if (outputFormat == "gap" || outputFormat == "gap-weighted") writeGapOmp(output, graph, outputFormat == "gap-weighted");
+  else writeEdgeList(output, graph);
 }
 
 /**
 * @brief Write the graph to the output file.
 * @param outputFile The ofstream object for the output file.
 * @param graph The graph object to be written.
+* @param outputFormat The output format (see writeOutputGraph).
+*/
+template <class G>
+void writeOutput(ofstream& outputFile, const G& graph, const string& outputFormat="edgelist") {
+  writeOutputGraph(outputFile, graph, outputFormat);
+  outputFile.close();
+}
+
+/**
+* @brief A batch update, handed off from the generator to the writer.
+* @note Everything that depends on the graph is captured here, so that the
+* generator can move on to the next batch while this one is written. Batch
+* outputs are recycled once written, so their buffers are reused; but the
+* formatted graph and checkpoint are released, so that idle batch outputs do
+* not each hold a copy of the graph.
+*/
+struct BatchOutput {
+  /** The counter value for the output file names. */
+  int counter = 0;
+  /** The number of rows of the updated graph (matrix-market-delta only). */
+  size_t rows = 0;
+  /** The edge deletions in the batch update. */
+  vector<tuple<int, int, int>> deletions;
+  /** The edge insertions in the batch update. */
+  vector<tuple<int, int, int>> insertions;
+  /** The updated graph, already formatted (edgelist, matrix-market only). */
+  unique_ptr<BlockStreamBuffer> snapshot;
+  /** The binary snapshot of the updated graph, if this batch is a checkpoint. */
+  unique_ptr<BlockStreamBuffer> checkpoint;
+  /** Is this batch a checkpoint? */
+  bool checkpointed = false;
+  /** The weights of the probability distribution (custom only). */
+  vector<double> weights;
+  /** The in-degree distribution of the updated graph. */
+  map<size_t, size_t> inDegreeDistribution;
+  /** The degree distribution of the updated graph. */
+  map<size_t, size_t> degreeDistribution;
+};
+
+/**
+* @brief Write the batch update, or the updated graph, to output files.
+* @param outputDir The directory path for the output files.
+* @param outputPrefix The prefix for the output file names.
+* @param outputFormat The output format (edgelist, matrix-market, delta, matrix-market-delta, binary).
+* @param batch The batch update, with the formatted snapshot for edgelist and matrix-market.
+* @note Matrix Market files have an .mtx extension; matrix-market-delta writes
+* deletions and insertions to separate .deletions.mtx and .insertions.mtx files.
+*/
+void writeOutput(const string& outputDir, const string& outputPrefix, const string& outputFormat, BatchOutput& batch) {
+  ofstream outputFile;
+  if (outputFormat == "matrix-market-delta") {
+    createOutputFile(outputDir, outputPrefix, batch.counter, outputFile, ".deletions.mtx");
+    writeBatchMtxOmp(outputFile, batch.deletions, batch.rows, false);
+    outputFile.close();
+    createOutputFile(outputDir, outputPrefix, batch.counter, outputFile, ".insertions.mtx");
+    writeBatchMtxOmp(outputFile, batch.insertions, batch.rows);
+    outputFile.close();
+    return;
+  }
+  createOutputFile(outputDir, outputPrefix, batch.counter, outputFile, outputSuffix(outputFormat));
+  if (outputFormat == "delta") writeBatchDelta(outputFile, batch.deletions, batch.insertions);
+  else if (outputFormat == "binary") writeBatchBinary(outputFile, batch.deletions, batch.insertions);
+  else if (batch.snapshot) batch.snapshot->writeTo(outputFile);
+  outputFile.close();
+  if (!outputFile) throw runtime_error("Failed to write batch update " + to_string(batch.counter));
+}
+
+/**
+* @brief Write the batch update to the streaming output, and flush it.
+* @param outputStream The streaming output.
+* @param outputFormat The output format (delta, binary).
+* @param batch The batch update.
+* @throws runtime_error if the batch update cannot be written (e.g., the consumer has exited).
+* @note A delta begins with a line "= <batch>". Binary batch updates are
+* delimited by their headers (see BatchHeader), and are written back to back.
+*/
+void writeOutputStream(ofstream& outputStream, const string& outputFormat, const BatchOutput& batch) {
+  if (outputFormat == "delta") {
+    outputStream << "= " << batch.counter << "\n";
+    writeBatchDelta(outputStream, batch.deletions, batch.insertions);
+  }
+  else writeBatchBinary(outputStream, batch.deletions, batch.insertions);
+  outputStream.flush();
+  if (!outputStream) throw runtime_error("Failed to stream batch update " + to_string(batch.counter));
+}
+
+/**
+* @brief Get the output shard of a source vertex.
+* @param u The source vertex.
+* @param shards The number of shards.
+* @param shardSpan The span of vertex ids split into contiguous ranges, or 0 to hash vertex ids.
+* @returns the shard, in [0, shards).
+* @note With ranges, shard s has the vertices [ceil(s*S/N), ceil((s+1)*S/N)), and
+* vertices beyond the span go to the last shard. Hashing uses Fibonacci hashing,
+* ((u * 0x9E3779B97F4A7C15) >> 32) % N, on 64-bit unsigned integers.
+*/
+inline size_t vertexShard(int u, size_t shards, size_t shardSpan) {
+  if (shardSpan > 0) return min(size_t(u) * shards / shardSpan, shards - 1);
+  return size_t((uint64_t(u) * 0x9E3779B97F4A7C15ULL) >> 32) % shards;
+}
+
+/**
+* @brief Write the map of output shards, for consumers to find their shard.
+* @param outputDir The directory path for the output files.
+* @param outputPrefix The prefix for the output file names.
+* @param shards The number of shards.
+* @param shardSpan The span of vertex ids split into contiguous ranges, or 0 to hash vertex ids.
+* @throws runtime_error if the file cannot be written.
+* @note The first line is "range <shards> <span>" or "hash <shards>". With
+* ranges, it is followed by a "<shard> <begin> <end>" line for each shard.
+*/
+void writeShardMap(const string& outputDir, const string& outputPrefix, size_t shards, size_t shardSpan) {
+  string outputFileName = outputDir + outputPrefix + ".shards";
+  ofstream outputFile(outputFileName);
+  if (shardSpan == 0) outputFile << "hash " << shards << "\n";
+  else {
+    outputFile << "range " << shards << " " << shardSpan << "\n";
+    for (size_t s=0; s<shards; ++s)
+      outputFile << s << " " << (s * shardSpan + shards - 1) / shards << " " << ((s+1) * shardSpan + shards - 1) / shards << "\n";
+  }
+  outputFile.close();
+  if (!outputFile) throw runtime_error("Failed to write file: " + outputFileName);
+}
+
+/**
+* @brief Write the base graph to output files, one per shard of source vertices.
+* @param outputDir The directory path for the output files.
+* @param outputPrefix The prefix for the output file names.
+* @param graph The graph object to be written.
+* @param mtx Write the shards in the Matrix Market format, instead of edgelist?
+* @param shards The number of shards.
+* @param shardSpan The span of vertex ids split into contiguous ranges, or 0 to hash vertex ids.
+* @throws runtime_error if any shard cannot be written.
+* @note Shards are named <prefix>_0.<shard>, and are written concurrently. Each
+* has the header of the whole graph, but with the number of edges in the shard.
+* Vertices are partitioned into shards once, so that each shard visits only
+* its own vertices.
+*/
+template <class G>
+void writeBaseShards(const string& outputDir, const string& outputPrefix, const G& graph, bool mtx, size_t shards, size_t shardSpan) {
+  size_t rows = graph.span() ? graph.span() - 1 : 0;
+  vector<size_t> sizes(shards);
+  vector<vector<int>> vertices(shards);
+  graph.forEachVertexKey([&](int u) {
+    size_t s = vertexShard(u, shards, shardSpan);
+    sizes[s] += graph.degree(u);
+    vertices[s].push_back(u);
+  });
+  vector<char> failed(shards);
+  #pragma omp parallel for schedule(dynamic, 1)
+  for (size_t s=0; s<shards; ++s) {
+    ofstream outputFile(outputDir + outputPrefix + "_0." + to_string(s) + (mtx ? ".mtx" : ""), std::ios::out | std::ios::binary);
+    if (mtx) writeMtxHeader(outputFile, false, mtxField<int>(true), rows, rows, sizes[s]);
+    else outputFile << graph.order() << " " << sizes[s] << "\n";
+    writeEdgelistVertices(outputFile, graph, vertices[s]);
+    outputFile.close();
+    failed[s] = !outputFile;
+  }
+  for (size_t s=0; s<shards; ++s)
+    if (failed[s]) throw runtime_error("Failed to write shard " + to_string(s) + " of base graph");
+}
+
+/**
+* @brief Write the batch update to output files, one per shard of source vertices.
+* @param outputDir The directory path for the output files.
+* @param outputPrefix The prefix for the output file names.
+* @param outputFormat The output format (delta, matrix-market-delta, binary).
+* @param batch The batch update.
+* @param shardDeletions The edge deletions of each shard (scratch, sized to the number of shards).
+* @param shardInsertions The edge insertions of each shard (scratch, sized to the number of shards).
+* @param shardSpan The span of vertex ids split into contiguous ranges, or 0 to hash vertex ids.
+* @throws runtime_error if any shard cannot be written.
+* @note Shards are named <prefix>_<n>.<shard> (before the .deletions.mtx and
+* .insertions.mtx extensions), and are written concurrently.
+*/
+void writeOutputShards(const string& outputDir, const string& outputPrefix, const string& outputFormat, const BatchOutput& batch, vector<vector<tuple<int, int, int>>>& shardDeletions, vector<vector<tuple<int, int, int>>>& shardInsertions, size_t shardSpan) {
+  size_t shards = shardDeletions.size();
+  auto fs = [&](int u) { return vertexShard(u, shards, shardSpan); };
+  #ifdef OPENMP
+  partitionBatchOmpW(shardDeletions,  batch.deletions,  fs);
+  partitionBatchOmpW(shardInsertions, batch.insertions, fs);
+  #else
+  partitionBatchW(shardDeletions,  batch.deletions,  fs);
+  partitionBatchW(shardInsertions, batch.insertions, fs);
+  #endif
+  string base = outputDir + outputPrefix + "_" + to_string(batch.counter) + ".";
+  vector<char> failed(shards);
+  #pragma omp parallel for schedule(dynamic, 1)
+  for (size_t s=0; s<shards; ++s) {
+    string outputFileName = base + to_string(s);
+    if (outputFormat == "matrix-market-delta") {
+      ofstream deletionsFile (outputFileName + ".deletions.mtx",  std::ios::out | std::ios::binary);
+      ofstream insertionsFile(outputFileName + ".insertions.mtx", std::ios::out | std::ios::binary);
+      writeBatchMtx(deletionsFile,  shardDeletions[s],  batch.rows, false);
+      writeBatchMtx(insertionsFile, shardInsertions[s], batch.rows);
+      deletionsFile.close();
+      insertionsFile.close();
+      failed[s] = !deletionsFile || !insertionsFile;
+    } else {
+      ofstream outputFile(outputFileName, std::ios::out | std::ios::binary);
+      if (outputFormat == "delta") writeBatchDelta(outputFile, shardDeletions[s], shardInsertions[s]);
+      else writeBatchBinary(outputFile, shardDeletions[s], shardInsertions[s]);
+      outputFile.close();
+      failed[s] = !outputFile;
+    }
+  }
+  for (size_t s=0; s<shards; ++s)
+    if (failed[s]) throw runtime_error("Failed to write shard " + to_string(s) + " of batch update " + to_string(batch.counter));
+}
+
+/**
+* @brief Format a binary snapshot of the graph, to be written as a checkpoint.
+* @param checkpoint The buffer for the snapshot (created if needed, and cleared).
+* @param graph The graph object to be written.
 */
-void writeOutput(ofstream& outputFile, const DiGraph<int, int, int>& graph) {
-  writeEdgeList(outputFile, graph);
+template <class G>
+void formatCheckpoint(unique_ptr<BlockStreamBuffer>& checkpoint, const G& graph) {
+  if (!checkpoint) checkpoint = make_unique<BlockStreamBuffer>();
+  checkpoint->clear();
+  ostream output(checkpoint.get());
+  writeSnapshot(output, graph);
+}
+
+/**
+* @brief Write a checkpoint (binary snapshot) of the graph, and add it to the checkpoint index.
+* @param outputDir The directory path for the output files.
+* @param outputPrefix The prefix for the output file names.
+* @param counter The batch number of the checkpoint.
+* @param checkpoint The binary snapshot of the graph.
+* @param checkpointIndex The checkpoint index file, with one "<batch> <file>" line per checkpoint.
+* @throws runtime_error if the checkpoint cannot be written.
+*/
+void writeCheckpoint(const string& outputDir, const string& outputPrefix, int counter, const BlockStreamBuffer& checkpoint, ofstream& checkpointIndex) {
+  string name = outputPrefix + "_" + to_string(counter) + ".snapshot";
+  ofstream outputFile(outputDir + name, std::ios::out | std::ios::binary);
+  checkpoint.writeTo(outputFile);
   outputFile.close();
+  if (!outputFile) throw runtime_error("Failed to write checkpoint: " + outputDir + name);
+  checkpointIndex << counter << " " << name << "\n";
+  checkpointIndex.flush();
+}
+
+/**
+* @brief Materialize the graph after a given batch update, from the nearest checkpoint before it.
+* @param outputDir The directory path of the output files.
+* @param outputPrefix The prefix of the output file names.
+* @param outputFormat The output format of the batch updates (binary, sequence).
+* @param batch The batch number to materialize the graph at.
+* @param graph The graph object to be populated.
+* @returns the batch number of the checkpoint that was loaded.
+* @throws runtime_error if there is no checkpoint at or before the batch, or its batch updates cannot be read.
+* @note At most (checkpoint interval - 1) batch updates are replayed, with applyBatchUpdateU().
+*/
+template <class G>
+size_t handleMaterialize(const string& outputDir, const string& outputPrefix, const string& outputFormat, size_t batch, G& graph) {
+  if (outputFormat != "binary" && outputFormat != "sequence") throw runtime_error("Checkpoints need binary or sequence output: " + outputFormat);
+  string indexFile = outputDir + outputPrefix + ".checkpoints";
+  ifstream checkpointIndex(indexFile);
+  if (!checkpointIndex) throw runtime_error("Failed to open checkpoint index: " + indexFile);
+  bool found = false;
+  size_t base = 0, counter = 0;
+  string baseFile, name;
+  while (checkpointIndex >> counter >> name) {
+    if (counter > batch || (found && counter < base)) continue;
+    base = counter; baseFile = name; found = true;
+  }
+  if (!found) throw runtime_error("No checkpoint at or before batch " + to_string(batch));
+  string checkpointFile = outputDir + baseFile;
+  #ifdef OPENMP
+  bool valid = readSnapshotOmpW(graph, checkpointFile.c_str(), 0, 0);
+  #else
+  bool valid = readSnapshotW(graph, checkpointFile.c_str(), 0, 0);
+  #endif
+  if (!valid) throw runtime_error("Invalid checkpoint: " + checkpointFile);
+  vector<tuple<int, int, int>> deletions, insertions;
+  if (outputFormat == "sequence") {
+    MappedFile sequenceFile((outputDir + outputPrefix + ".seq").c_str());
+    for (size_t k=base+1; k<=batch; ++k) {
+      readSequenceBatchW(deletions, insertions, sequenceFile.view(), k-1);
+      applyBatchUpdateU(graph, deletions, insertions);
+    }
+  } else {
+    for (size_t k=base+1; k<=batch; ++k) {
+      string batchFile = outputDir + outputPrefix + "_" + to_string(k);
+      readBatchBinaryW(deletions, insertions, batchFile.c_str());
+      applyBatchUpdateU(graph, deletions, insertions);
+    }
+  }
+  return base;
 }
 
 /**
@@ -222,23 +690,70 @@ void calculateInDegreeDistribution(const G& graph, std::map<size_t, size_t>& dis
 }
 
 template <typename G, typename K>
-void calculateDegreeDistribution(const G& graph) {
-    std::map<size_t, size_t> degreeDistribution;
-
+void calculateDegreeDistribution(const G& graph, std::map<size_t, size_t>& distribution) {
     graph.forEachVertexKey([&](K u) {
         size_t degree = graph.degree(u);
-        degreeDistribution[degree]++;
+        distribution[degree]++;
     });
+}
+
+#ifdef OPENMP
+/**
+* @brief Calculate the in-degree and degree distributions of the graph in parallel.
+* @param graph The graph object.
+* @param inDistribution The in-degree distribution (updated; left unchanged if in-edges are not stored).
+* @param distribution The degree distribution (updated).
+* @note Each thread counts its range of vertices in its own histograms, which
+* are then merged; there are far fewer distinct degrees than vertices.
+*/
+template <typename G, typename K>
+void calculateDegreeDistributionsOmp(const G& graph, std::map<size_t, size_t>& inDistribution, std::map<size_t, size_t>& distribution) {
+    size_t S = graph.span();
+    #pragma omp parallel
+    {
+        std::map<size_t, size_t> inLocal, local;
+        #pragma omp for schedule(static, 2048) nowait
+        for (size_t u=0; u<S; ++u) {
+            if (!graph.hasVertex(K(u))) continue;
+            if constexpr (G::hasInEdges()) inLocal[graph.indegree(K(u))]++;
+            local[graph.degree(K(u))]++;
+        }
+        #pragma omp critical
+        {
+            for (const auto& pair : inLocal) inDistribution[pair.first] += pair.second;
+            for (const auto& pair : local)   distribution[pair.first]   += pair.second;
+        }
+    }
+}
+#endif
 
+void printDegreeDistribution(const std::map<size_t, size_t>& distribution) {
     std::cout << "Degree Distribution:" << std::endl;
-    for (const auto& pair : degreeDistribution) {
+    for (const auto& pair : distribution) {
         std::cout << "Degree " << pair.first << ": " << pair.second << " vertices" << std::endl;
     }
 }
 
 
-void handleUpdateNature(const string& probabilityDistribution, const string& updateNature, DiGraph<int, int, int>& graph, mt19937_64& rng, size_t batchSize, double edgeDeletions, double edgeInsertions,vector<double>& weights, bool allowDuplicateEdges = true) {
-  vector<tuple<int, int, int>> insertions, deletions;
+/**
+* @brief Generate a batch update of the given update nature, and apply it to the graph.
+* @param probabilityDistribution The probability distribution function to use for the update.
+* @param updateNature The update nature (uniform, preferential, planted, match).
+* @param graph The graph object to be updated.
+* @param rng The random number generator.
+* @param batchSize The number of edges in the batch update.
+* @param edgeDeletions The fraction of the batch to be edge deletions.
+* @param edgeInsertions The fraction of the batch to be edge insertions.
+* @param weights The weights of the probability distribution (custom only).
+* @param deletions The edge deletions in the batch update (output).
+* @param insertions The edge insertions in the batch update (output).
+* @param allowDuplicateEdges Allow duplicate edges in the batch update.
+* @throws runtime_error if the update nature is unknown.
+*/
+template <class G>
+void handleUpdateNature(const string& probabilityDistribution, const string& updateNature, G& graph, mt19937_64& rng, size_t batchSize, double edgeDeletions, double edgeInsertions, vector<double>& weights, vector<tuple<int, int, int>>& deletions, vector<tuple<int, int, int>>& insertions, bool allowDuplicateEdges = true) {
+  deletions.clear();
+  insertions.clear();
   if (updateNature == "") {
     weights = customUpdate(probabilityDistribution ,rng, graph, batchSize, edgeInsertions, edgeDeletions, insertions, deletions, allowDuplicateEdges);
   } else if (updateNature == "uniform") {
@@ -254,25 +769,56 @@ void handleUpdateNature(const string& probabilityDistribution, const string& upd
   }
   applyBatchUpdateU(graph, deletions, insertions);
 }
+
+
+/**
+* @brief Read the next batch of edge insertions from a temporal edge stream, and apply it.
+* @param temporalStream The temporal edge stream.
+* @param temporalLine The pending line, carried over between batches.
+* @param graph The graph object to be updated.
+* @param batchSize The maximum number of edges in the batch (0 for no limit).
+* @param temporalWindow The time span of the batch (0 for no limit).
+* @param temporalShift The offset added to vertex ids, 1 if they are 0-based.
+* @param deletions The edge deletions in the batch update (output, always empty).
+* @param insertions The edge insertions in the batch update (output).
+* @param allowDuplicateEdges Allow duplicate edges in the batch update.
+* @returns number of edges read from the stream (0 when it is exhausted)
+* @throws runtime_error if an edge has vertex id 0, but ids were not found to be 0-based in the base graph.
+*/
+template <class G>
+size_t handleTemporalBatch(ifstream& temporalStream, string& temporalLine, G& graph, size_t batchSize, size_t temporalWindow, size_t temporalShift, vector<tuple<int, int, int>>& deletions, vector<tuple<int, int, int>>& insertions, bool allowDuplicateEdges) {
+  deletions.clear();
+  insertions.clear();
+  size_t n = readTemporalBatchDo(temporalStream, temporalLine, batchSize, temporalWindow, temporalShift, [&](auto u, auto v, auto t) {
+    if (u == 0 || v == 0) throw runtime_error("Temporal edge with vertex id 0 after the base graph; use --temporal-zero-based");
+    insertions.push_back({int(u), int(v), 1});
+  });
+  if (!allowDuplicateEdges) tidyBatchUpdateU(deletions, insertions, graph);
+  applyBatchUpdateU(graph, deletions, insertions);
+  return n;
+}
 #pragma endregion
 
 #pragma region MAIN HANDLER
 /**
- * @brief Handles the processing of options passed to the program.
+ * @brief Handles the processing of options passed to the program, on a given graph type.
+ * @tparam G The graph type (with or without in-edges).
  * @param options A map containing the options and their corresponding values.
  */
-void handleOptions(const Options& options) {
+template <class G>
+void handleOptionsWith(const Options& options) {
   auto startTime = timeNow();
-  if (options.params.count("help")) {
-    cout << helpMessage();
-    return;
-  }
   vector<string> inputTransform = options.transforms;
   string inputGraph = options.params.count("input-graph") ? options.params.at("input-graph") : "";
   string inputFormat = options.params.count("input-format") ? options.params.at("input-format") : "";
+  string cacheDir = options.params.count("cache-dir") ? options.params.at("cache-dir") : "";
   string outputDir = options.params.count("output-dir") ? options.params.at("output-dir") : "";
   string outputPrefix = options.params.count("output-prefix") ? options.params.at("output-prefix") : "";
   string outputFormat = options.params.count("output-format") ? options.params.at("output-format") : string("edgelist");
+  string output = options.params.count("output") ? options.params.at("output") : "";
+  size_t outputShards = options.params.count("output-shards") ? stoull(options.params.at("output-shards")) : 0;
+  string outputShardBy = options.params.count("output-shard-by") ? options.params.at("output-shard-by") : string("range");
+  bool outputBase = options.params.count("output-base");
   int64_t batchSize = options.params.count("batch-size") ? stoll(options.params.at("batch-size")) : 0;
   double batchSizeRatio = options.params.count("batch-size-ratio") ? stod(options.params.at("batch-size-ratio")) : 0.0;
   double edgeInsertions = options.params.count("edge-insertions") ? stod(options.params.at("edge-insertions")) : 0.0;
@@ -290,13 +836,62 @@ void handleOptions(const Options& options) {
   bool preserveDegreeDistribution = options.params.count("preserve-degree-distribution");
   bool preserveCommunities = options.params.count("preserve-communities");
   int64_t preserveKCore = options.params.count("preserve-k-core") ? stoll(options.params.at("preserve-k-core")) : 0;
-  int64_t multiBatch = options.params.count("multi-batch") ? stoll(options.params.at("multi-batch")) : 1;
+  bool temporal = inputFormat == "snap-temporal";
+  size_t temporalBase = options.params.count("temporal-base") ? stoull(options.params.at("temporal-base")) : 0;
+  size_t temporalWindow = options.params.count("temporal-window") ? stoull(options.params.at("temporal-window")) : 0;
+  size_t readBlock = options.params.count("read-block") ? stoull(options.params.at("read-block")) : READ_BLOCK_LINES;
+  size_t checkpointEvery = options.params.count("checkpoint-every") ? stoull(options.params.at("checkpoint-every")) : 0;
+  size_t outputQueue = options.params.count("output-queue") ? stoull(options.params.at("output-queue")) : (isSnapshotOutput(outputFormat) ? 1 : 2);
+  int64_t multiBatch = options.params.count("multi-batch") ? stoll(options.params.at("multi-batch")) : (temporal ? INT64_MAX : 1);
   random_device rd;
   int64_t seed = options.params.count("seed") ? stoll(options.params.at("seed")) : rd();
-  DiGraph<int, int, int> graph;
-  checkInputFile(inputGraph);
-  handleInputFormat(inputFormat, graph, inputGraph);
-  printf("Read graph: %.3f seconds\n", duration(startTime) / 1000.0);
+  G graph;
+  ifstream temporalStream;
+  string temporalLine;
+  bool temporalZeroBased = options.params.count("temporal-zero-based");  // 0-based vertex ids are shifted by 1, as with edgelists.
+  checkOutputFormat(outputFormat);
+  if (readBlock == 0) throw runtime_error("--read-block needs at least 1 line");
+  if (options.params.count("materialize")) {
+    size_t batch = stoull(options.params.at("materialize"));
+    size_t base  = handleMaterialize(outputDir, outputPrefix, outputFormat, batch, graph);
+    printf("Materialize batch update %zu (from checkpoint %zu): %.3f seconds\n", batch, base, duration(startTime) / 1000.0);
+    ofstream outputFile;
+    int counter = int(batch);
+    createOutputFile(outputDir, outputPrefix, counter, outputFile, ".edgelist");
+    writeOutput(outputFile, graph);
+    printf("Write materialized graph: %.3f seconds\n", duration(startTime) / 1000.0);
+    return;
+  }
+  if (checkpointEvery > 0 && outputFormat != "binary" && outputFormat != "sequence") throw runtime_error("Checkpoints need binary or sequence output: " + outputFormat);
+  bool streaming = !output.empty();
+  if (streaming && outputFormat != "delta" && outputFormat != "binary") throw runtime_error("Streaming output needs delta or binary output: " + outputFormat);
+  if (streaming && checkpointEvery > 0) throw runtime_error("Checkpoints need batch update files, not streaming output");
+  bool shardedOutput = outputShards > 0;
+  if (shardedOutput && outputFormat != "delta" && outputFormat != "matrix-market-delta" && outputFormat != "binary") throw runtime_error("Sharded output needs delta, matrix-market-delta or binary output: " + outputFormat);
+  if (shardedOutput && (streaming || checkpointEvery > 0)) throw runtime_error("Sharded output cannot be streamed, or checkpointed");
+  if (shardedOutput && outputShardBy != "range" && outputShardBy != "hash") throw runtime_error("Unknown output shard method: " + outputShardBy);
+  ofstream outputStream;
+  if (streaming) createOutputStream(output, outputStream);
+  vector<string> inputShards = expandPath(inputGraph);
+  if (inputShards.empty()) throw runtime_error("Input graph file not found: " + inputGraph);
+  for (const string& shard : inputShards)
+    checkInputFile(shard);
+  bool sharded = inputShards.size() > 1 || inputShards[0] != inputGraph;
+  if (sharded && inputShards.size() == 1) {
+    inputGraph = inputShards[0];
+    sharded = false;
+  }
+  if (sharded) {
+    size_t bytes = handleInputShards(inputFormat, graph, inputShards);
+    double seconds = duration(startTime) / 1000.0;
+    printf("Read graph (%zu shards): %.3f seconds (%.1f MB/s)\n", inputShards.size(), seconds, seconds > 0 ? bytes / 1e6 / seconds : 0.0);
+  } else if (!cacheDir.empty() && !temporal) {
+    bool cached = handleInputCache(cacheDir, inputFormat, graph, inputGraph);
+    printf("Read graph%s: %.3f seconds\n", cached ? " (snapshot)" : "", duration(startTime) / 1000.0);
+  } else {
+    handleInputFormat(inputFormat, graph, inputGraph, temporalStream, temporalBase, temporalZeroBased, readBlock);
+    printf("Read graph: %.3f seconds\n", duration(startTime) / 1000.0);
+  }
   for(int i=0; i<inputTransform.size(); i++) {
     handleInputTransform(inputTransform[i], graph);
     printf("Perform transform %s: %.3f seconds\n", inputTransform[i].c_str(), duration(startTime) / 1000.0);
@@ -304,42 +899,154 @@ void handleOptions(const Options& options) {
   int counter = 0;
   ofstream outputFile;
   mt19937_64 rng(seed);
-  while (multiBatch--) {
-    if (batchSize == 0) batchSize = graph.size() * batchSizeRatio;
-    vector <double> weights;
-    handleUpdateNature(probabilityDistribution, updateNature, graph, rng, batchSize, edgeDeletions, edgeInsertions,weights, allowDuplicateEdges);
-
-    // for(int o=0;o<weights.size();o++)
-    // cout<<weights[o]<<" ";
-    // cout<<endl;
-
-    // return;
-    std::vector<double> normalised_weights_actual = normalize(weights);
-    std::map<size_t, size_t> inDegreeDistribution;
-    calculateInDegreeDistribution<DiGraph<int, int, int>, int>(graph, inDegreeDistribution);
-    std::vector<double> normalised_weights_real= degreeDistributionToProbability(inDegreeDistribution);
-
-    
-
+  size_t shardSpan = outputShardBy == "range" ? max(graph.span(), size_t(1)) : 0;
+  if (shardedOutput) writeShardMap(outputDir, outputPrefix, outputShards, shardSpan);
+  if (outputBase && shardedOutput) {
+    writeBaseShards(outputDir, outputPrefix, graph, isMtxOutput(outputFormat), outputShards, shardSpan);
+    printf("Write base graph (%zu shards): %.3f seconds\n", outputShards, duration(startTime) / 1000.0);
+  } else if (outputBase) {
+    createOutputFile(outputDir, outputPrefix, counter, outputFile, outputSuffix(outputFormat));
+    writeOutput(outputFile, graph, outputFormat);
+    printf("Write base graph: %.3f seconds\n", duration(startTime) / 1000.0);
+  }
+  ofstream checkpointIndex;
+  if (checkpointEvery > 0) {
+    string indexFile = outputDir + outputPrefix + ".checkpoints";
+    checkpointIndex.open(indexFile);
+    if (!checkpointIndex) throw runtime_error("Failed to create file: " + indexFile);
+    unique_ptr<BlockStreamBuffer> checkpoint;
+    formatCheckpoint(checkpoint, graph);
+    writeCheckpoint(outputDir, outputPrefix, counter, *checkpoint, checkpointIndex);
+    printf("Write checkpoint %d: %.3f seconds\n", counter, duration(startTime) / 1000.0);
+  }
+  bool sequence = outputFormat == "sequence";
+  ofstream sequenceFile;
+  vector<uint64_t> sequenceOffsets;
+  if (sequence) {
+    createSequenceFile(outputDir, outputPrefix, sequenceFile);
+    writeSequenceHeader<int, int>(sequenceFile, sequenceOffsets);
+  }
+  // Batches are written (with their statistics) on a separate thread, while the next is generated.
+  BlockingQueue<BatchOutput> outputs(outputQueue), recycled(outputQueue + 1);
+  for (size_t i=0; i<=outputQueue; ++i)
+    recycled.push(BatchOutput());
+  atomic<bool> writeFailed(false);
+  exception_ptr writeError;
+  vector<vector<tuple<int, int, int>>> shardDeletions(outputShards), shardInsertions(outputShards);
+  thread writer([&]() {
+    #ifdef OPENMP
+    // The writer mostly waits on I/O, so it gets a share of the threads, and not a full team alongside the generator's.
+    omp_set_num_threads(max(1, omp_get_max_threads() / 4));
+    #endif
+    BatchOutput batch;
+    while (outputs.pop(batch)) {
+      if (writeFailed) { recycled.push(move(batch)); continue; }
+      try {
+        printDegreeDistribution(batch.degreeDistribution);
+        if (streaming) writeOutputStream(outputStream, outputFormat, batch);
+        else if (sequence) writeSequenceBatchOmp(sequenceFile, sequenceOffsets, batch.deletions, batch.insertions);
+        else if (shardedOutput) writeOutputShards(outputDir, outputPrefix, outputFormat, batch, shardDeletions, shardInsertions, shardSpan);
+        else writeOutput(outputDir, outputPrefix, outputFormat, batch);
+        printf("Write batch update %d: %.3f seconds\n", batch.counter, duration(startTime) / 1000.0);
+        if (batch.checkpointed) {
+          writeCheckpoint(outputDir, outputPrefix, batch.counter, *batch.checkpoint, checkpointIndex);
+          printf("Write checkpoint %d: %.3f seconds\n", batch.counter, duration(startTime) / 1000.0);
+        }
+        if (G::hasInEdges()) {
+          std::vector<double> normalised_weights_actual = normalize(batch.weights);
+          std::vector<double> normalised_weights_real = degreeDistributionToProbability(batch.inDegreeDistribution);
+          try {
+              double divergence = KLDivergence(normalised_weights_real, normalised_weights_actual);
+              std::cout << "KL Divergence: " << divergence << std::endl;
+          } catch (const std::invalid_argument& e) {
+              std::cerr << "Error: " << e.what() << std::endl;
+          }
+        }
+      } catch (...) {
+        writeError = current_exception();
+        writeFailed = true;
+      }
+      batch.snapshot.reset();
+      batch.checkpoint.reset();
+      recycled.push(move(batch));
+    }
+  });
+  try {
+    while (multiBatch-- && !writeFailed) {
+      if (batchSize == 0) batchSize = graph.size() * batchSizeRatio;
+      BatchOutput batch;
+      recycled.pop(batch);
+      batch.weights.clear();
+      if (temporal) {
+        if (batchSize == 0 && temporalWindow == 0) throw runtime_error("snap-temporal input needs a batch size or a temporal window");
+        if (handleTemporalBatch(temporalStream, temporalLine, graph, batchSize, temporalWindow, temporalZeroBased? 1 : 0, batch.deletions, batch.insertions, allowDuplicateEdges) == 0) break;
+      }
+      else handleUpdateNature(probabilityDistribution, updateNature, graph, rng, batchSize, edgeDeletions, edgeInsertions, batch.weights, batch.deletions, batch.insertions, allowDuplicateEdges);
+      batch.counter = ++counter;
+      batch.rows = graph.span() ? graph.span() - 1 : 0;
+      batch.inDegreeDistribution.clear();
+      batch.degreeDistribution.clear();
+      #ifdef OPENMP
+      calculateDegreeDistributionsOmp<G, int>(graph, batch.inDegreeDistribution, batch.degreeDistribution);
+      #else
+      if constexpr (G::hasInEdges()) calculateInDegreeDistribution<G, int>(graph, batch.inDegreeDistribution);
+      calculateDegreeDistribution<G, int>(graph, batch.degreeDistribution);
+      #endif
+      if (isSnapshotOutput(outputFormat)) {
+        if (!batch.snapshot) batch.snapshot = make_unique<BlockStreamBuffer>();
+        batch.snapshot->clear();
+        ostream snapshot(batch.snapshot.get());
+        writeOutputGraph(snapshot, graph, outputFormat);
+      }
+      batch.checkpointed = checkpointEvery > 0 && counter % checkpointEvery == 0;
+      if (batch.checkpointed) formatCheckpoint(batch.checkpoint, graph);
+      printf("Perform batch update %d: %.3f seconds\n", counter, duration(startTime) / 1000.0);
+      outputs.push(move(batch));
+    }
+  } catch (...) {
+    outputs.close();
+    writer.join();
+    throw;
+  }
+  outputs.close();
+  writer.join();
+  if (writeError) rethrow_exception(writeError);
+  if (streaming) outputStream.close();
+  if (sequence) {
+    writeSequenceIndex<int, int>(sequenceFile, sequenceOffsets);
+    sequenceFile.close();
+    if (!sequenceFile) throw runtime_error("Failed to write sequence of batch updates");
+    printf("Write sequence of %zu batch updates: %.3f seconds\n", sequenceOffsets.size() - 1, duration(startTime) / 1000.0);
+  }
+}
 
 
-    calculateDegreeDistribution<DiGraph<int, int, int>, int>(graph);
-    printf("Perform batch update %d: %.3f seconds\n", counter+1, duration(startTime) / 1000.0);
-    createOutputFile(outputDir, outputPrefix, ++counter, outputFile);
-    writeOutput(outputFile, graph);
-    printf("Write batch update %d: %.3f seconds\n", counter, duration(startTime) / 1000.0);
+/**
+ * @brief Check if the options need in-degrees of the graph.
+ * @param options A map containing the options and their corresponding values.
+ * @returns true if the custom update nature is used (its KL divergence is
+ * reported against the in-degree distribution), false otherwise.
+ */
+bool needsInDegrees(const Options& options) {
+  string inputFormat = options.params.count("input-format") ? options.params.at("input-format") : "";
+  string updateNature = options.params.count("update-nature") ? options.params.at("update-nature") : "";
+  if (options.params.count("materialize")) return false;
+  return inputFormat != "snap-temporal" && updateNature == "";
+}
 
-    // for(int kk=0;kk<normalised_weights_real.size();kk++)
-    // cout<<normalised_weights_actual[kk]<<' ';
-    // cout<<endl;
 
-    try {
-        double divergence = KLDivergence(normalised_weights_real, normalised_weights_actual);
-        std::cout << "KL Divergence: " << divergence << std::endl;
-    } catch (const std::invalid_argument& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-    }
+/**
+ * @brief Handles the processing of options passed to the program.
+ * @param options A map containing the options and their corresponding values.
+ * @note In-edges are stored only if the options need in-degrees.
+ */
+void handleOptions(const Options& options) {
+  if (options.params.count("help")) {
+    cout << helpMessage();
+    return;
   }
+  if (needsInDegrees(options)) handleOptionsWith<DiGraph<int, int, int>>(options);
+  else handleOptionsWith<DiGraph<int, int, int, false>>(options);
 }
 #pragma endregion
 #pragma endregion
@@ -101,9 +101,21 @@ inline Options readOptions(int argc, char **argv) {
     else if (k=="--input-graph")     o.params["input-graph"]     = argv[++i];
     else if (k=="--input-format")    o.params["input-format"]    = argv[++i];
     else if (k=="--input-transform"){ while (i+1<argc && argv[i+1][0]!='-') o.transforms.push_back(argv[++i]);}
+    else if (k=="--cache-dir")       o.params["cache-dir"]       = argv[++i];
+    else if (k=="--temporal-base")   o.params["temporal-base"]   = argv[++i];
+    else if (k=="--temporal-window") o.params["temporal-window"] = argv[++i];
+    else if (k=="--temporal-zero-based") o.params["temporal-zero-based"] = "1";
+    else if (k=="--read-block")      o.params["read-block"]      = argv[++i];
     else if (k=="--output-dir")      o.params["output-dir"]    = argv[++i];
     else if (k=="--output-prefix")   o.params["output-prefix"] = argv[++i];
     else if (k=="--output-format")   o.params["output-format"] = argv[++i];
+    else if (k=="--output")          o.params["output"]        = argv[++i];
+    else if (k=="--output-shards")   o.params["output-shards"] = argv[++i];
+    else if (k=="--output-shard-by") o.params["output-shard-by"] = argv[++i];
+    else if (k=="--output-base")     o.params["output-base"]   = "1";
+    else if (k=="--output-queue")    o.params["output-queue"]  = argv[++i];
+    else if (k=="--checkpoint-every") o.params["checkpoint-every"] = argv[++i];
+    else if (k=="--materialize")      o.params["materialize"]      = argv[++i];
     else if (k=="--batch-size")       o.params["batch-size"]       = argv[++i];
     else if (k=="--batch-size-ratio") o.params["batch-size-ratio"] = argv[++i];
     else if (k=="--edge-insertions")  o.params["edge-insertions"]  = argv[++i];
@@ -137,19 +149,66 @@ inline Options readOptions(int argc, char **argv) {
  * @returns something helpful
  */
 inline const char* helpMessage() {
-  // Input formats: edgelist,matrix-market,snap-temporal
+  // Input formats: edgelist,matrix-market,snap-temporal,ligra,gap
   // Input transforms: transpose,unsymmetrize,symmetrize,loop-deadends,loop-vertices,clear-weights,set-weights
-  // Output formats: edgelist
+  // Output formats: edgelist, matrix-market, ligra, ligra-weighted, gap, gap-weighted, delta, matrix-market-delta, binary, sequence
   const char *message =
   "Usage: graph-generate [OPTIONS]\n"
   "\n"
   "Options:\n"
-  "  --input-graph <file>           Path to the input static graph file.\n"
-  "  --input-format <format>        Format of the input static graph file.\n"
+  "  --input-graph <file>           Path to the input static graph file; or a directory or glob\n"
+  "                                 of edgelist shards, which are loaded concurrently.\n"
+  "  --input-format <format>        Format of the input static graph file (edgelist, matrix-market,\n"
+  "                                 snap-temporal, ligra for a Ligra AdjacencyGraph, or gap for a\n"
+  "                                 GAP serialized graph, weighted if named .wsg).\n"
   "  --input-transform <transforms> Transformations to apply to the input graph.\n"
   "  --output-dir <directory>       Directory to save the generated dynamic graphs.\n"
   "  --output-prefix <prefix>       Prefix for the generated dynamic graph files.\n"
-  "  --output-format <format>       Format of the generated batch updates.\n"
+  "  --output-format <format>       Format of the generated batch updates. Options:\n"
+  "                                   edgelist: The whole updated graph, after each batch (default).\n"
+  "                                   matrix-market: The whole updated graph, as <prefix>_<n>.mtx.\n"
+  "                                   ligra, ligra-weighted: The whole updated graph, as a Ligra\n"
+  "                                     (Weighted)AdjacencyGraph <prefix>_<n>.adj, with 0-based ids.\n"
+  "                                   gap, gap-weighted: The whole updated graph, as a GAP serialized\n"
+  "                                     graph <prefix>_<n>.sg (or .wsg), with 0-based ids.\n"
+  "                                   delta: Only the edge deletions (- D) and insertions (+ I) of each batch.\n"
+  "                                   matrix-market-delta: Deletions and insertions of each batch, as\n"
+  "                                     <prefix>_<n>.deletions.mtx and <prefix>_<n>.insertions.mtx.\n"
+  "                                   binary: Each batch as packed arrays, to be mapped (see inc/delta.hxx).\n"
+  "                                   sequence: All batches in one compressed file, with an index (<prefix>.seq).\n"
+  "  --output <path>                Stream all batch updates to stdout (-) or a named pipe, instead\n"
+  "                                 of numbered files (delta, with a \"= <batch>\" line before each,\n"
+  "                                 or binary). Generation waits while the consumer falls behind.\n"
+  "  --output-shards <shards>       Split each batch update (and the base graph) by source vertex\n"
+  "                                 into N files, <prefix>_<n>.<shard>, written concurrently; shards\n"
+  "                                 are listed in <prefix>.shards (delta, matrix-market-delta, binary).\n"
+  "  --output-shard-by <method>     Split source vertices into contiguous ranges (range, default),\n"
+  "                                 or by a hash of their ids (hash).\n"
+  "  --output-base                  Also write the base graph once, with counter 0 (in the output\n"
+  "                                 format for whole graphs, as .mtx for matrix-market-delta, or\n"
+  "                                 else as edgelist).\n"
+  "  --output-queue <batches>       Number of generated batches that may wait to be written, while\n"
+  "                                 the next is generated (default: 1 for whole-graph formats,\n"
+  "                                 else 2).\n"
+  "  --checkpoint-every <batches>   Also write a binary snapshot of the graph every k batches\n"
+  "                                 (and of the base graph), as <prefix>_<n>.snapshot, listed\n"
+  "                                 in <prefix>.checkpoints (binary, sequence output only).\n"
+  "  --materialize <batch>          Instead of generating, rebuild the graph after a batch from\n"
+  "                                 the nearest checkpoint and the batch updates after it, in\n"
+  "                                 --output-dir, and write it as <prefix>_<batch>.edgelist.\n"
+  "  --cache-dir <directory>        Directory to keep binary snapshots of input graphs in, for\n"
+  "                                 faster reloads (not for snap-temporal).\n"
+  "\n"
+  "Temporal Input (snap-temporal):\n"
+  "  --temporal-base <edges>        Number of leading edges to load as the base graph. The input\n"
+  "                                 must be a regular file, as these edges are read twice (first\n"
+  "                                 for the number of vertices); later edges are read once.\n"
+  "  --temporal-window <time>       Time span of each batch of replayed edges (by timestamp).\n"
+  "                                 Remaining edges are replayed as batches, limited by\n"
+  "                                 --batch-size and/or --temporal-window, until exhausted.\n"
+  "  --temporal-zero-based          Vertex ids are 0-based (and are shifted by 1). This is also\n"
+  "                                 assumed if the base graph has vertex id 0.\n"
+  "  --read-block <lines>           Number of lines (at least 1) to read at a time, while parsing the last.\n"
   "\n"
   "Batch Size:\n"
   "  --batch-size <size>           Absolute size of each batch update.\n"
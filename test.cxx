@@ -0,0 +1,81 @@
+#include <cstdio>
+#include <utility>
+#include <vector>
+#include "inc/_main.hxx"
+
+using namespace std;
+
+
+
+
+#pragma region HELPERS
+/** Number of failed checks. */
+int failures = 0;
+
+/**
+* @brief Check that a condition holds, and report it if not.
+* @param ok The condition.
+* @param name The name of the check.
+*/
+void check(bool ok, const char *name) {
+  if (ok) return;
+  printf("FAILED: %s\n", name);
+  ++failures;
+}
+
+/**
+* @brief Add keyed entries to a sorted list, keeping the last entry among matching keys.
+* @param x The sorted list of (key, value) entries.
+* @param y The sorted entries to add.
+* @returns the updated list.
+*/
+vector<pair<int, int>> unionByKey(vector<pair<int, int>> x, const vector<pair<int, int>>& y) {
+  auto fl = [](const auto& a, const auto& b) { return a.first <  b.first; };
+  auto fe = [](const auto& a, const auto& b) { return a.first == b.first; };
+  size_t X = x.size();
+  vector<pair<int, int>> buf(y.size() + 3);
+  x.resize(X + y.size());
+  auto it = set_union_last_inplace(x.begin(), x.begin() + X, y.begin(), y.end(), buf.begin(), buf.end(), fl, fe);
+  x.resize(it - x.begin());
+  return x;
+}
+#pragma endregion
+
+
+
+
+#pragma region TESTS
+/**
+* @brief An added entry replaces a matching entry of the input that was saved to the deque.
+*/
+void testSetUnionLastReplacesSaved() {
+  using P = vector<pair<int, int>>;
+  check(unionByKey({{1, 0}, {3, 0}}, {{2, 1}, {3, 1}}) == P({{1, 0}, {2, 1}, {3, 1}}), "set_union_last_inplace replaces saved entry");
+  check(unionByKey({{1, 0}, {3, 0}, {4, 0}}, {{2, 1}, {3, 1}, {4, 1}}) == P({{1, 0}, {2, 1}, {3, 1}, {4, 1}}), "set_union_last_inplace replaces saved entries");
+}
+
+/**
+* @brief Added entries with matching keys, beyond the end of the input, are deduplicated by key.
+*/
+void testSetUnionLastUniqueByKey() {
+  using P = vector<pair<int, int>>;
+  check(unionByKey({}, {{5, 1}, {5, 2}}) == P({{5, 2}}), "set_union_last_inplace dedups by key into empty input");
+  check(unionByKey({{1, 0}}, {{5, 1}, {5, 2}, {6, 1}}) == P({{1, 0}, {5, 2}, {6, 1}}), "set_union_last_inplace dedups by key past input");
+}
+#pragma endregion
+
+
+
+
+#pragma region MAIN
+/**
+* @brief Run all tests.
+* @returns zero if all checks pass.
+*/
+int main() {
+  testSetUnionLastReplacesSaved();
+  testSetUnionLastUniqueByKey();
+  printf(failures ? "%d checks failed\n" : "All checks passed\n", failures);
+  return failures ? 1 : 0;
+}
+#pragma endregion
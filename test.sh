@@ -0,0 +1,3 @@
+#!/usr/bin/env bash
+# Build and run the regression checks.
+g++ -std=c++17 -O3 test.cxx -o test.out && ./test.out